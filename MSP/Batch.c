@@ -0,0 +1,159 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <limits.h>
+#include "MSP.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MSP_HAVE_X86 1
+#endif
+
+// The series [first, last) of a column-major block, one at a time with the scalar scan.
+// values[t * series + s] is the t-th element of series s.
+static void batchScalar(const int32_t *values, unsigned long long series, unsigned long long length,
+                        unsigned long long first, unsigned long long last,
+                        long long *best, unsigned long long *from, unsigned long long *to)
+{
+  for (unsigned long long s = first; s < last; s++)
+  {
+    long long sum = 0;
+    long long minSum = 0;
+    unsigned long long minFrom = 0;
+    best[s] = LLONG_MIN;
+    for (unsigned long long t = 0; t < length; t++)
+    {
+      sum += values[t * series + s];
+      if (sum - minSum > best[s])
+      {
+        best[s] = sum - minSum;
+        from[s] = minFrom;
+        to[s] = t + 1;
+      }
+      if (sum < minSum)
+      {
+        minSum = sum;
+        minFrom = t + 1;
+      }
+    }
+  }
+}
+
+#ifdef MSP_HAVE_X86
+
+// One time step of the scan of eight series in the lanes of a register
+#define BATCH_STEP_512(k, x)                                              \
+  {                                                                       \
+    sum[k] = _mm512_add_epi64(sum[k], (x));                               \
+    __m512i candidate = _mm512_sub_epi64(sum[k], minSum[k]);              \
+    __mmask8 better = _mm512_cmpgt_epi64_mask(candidate, best[k]);        \
+    best[k] = _mm512_mask_mov_epi64(best[k], better, candidate);          \
+    bestFrom[k] = _mm512_mask_mov_epi64(bestFrom[k], better, minFrom[k]); \
+    bestTo[k] = _mm512_mask_mov_epi64(bestTo[k], better, end);            \
+    __mmask8 lower = _mm512_cmplt_epi64_mask(sum[k], minSum[k]);          \
+    minSum[k] = _mm512_mask_mov_epi64(minSum[k], lower, sum[k]);          \
+    minFrom[k] = _mm512_mask_mov_epi64(minFrom[k], lower, end);           \
+  }
+
+// Sixteen series at a time, i.e. one cache line of every row, in two registers of eight 64-bit lanes
+__attribute__((target("avx512f"))) static void batchAvx512(const int32_t *values, unsigned long long series,
+                                                           unsigned long long length, long long *bestOut,
+                                                           unsigned long long *from, unsigned long long *to)
+{
+  unsigned long long s = 0;
+  for (; s + 16 <= series; s += 16)
+  {
+    const __m512i zero = _mm512_setzero_si512();
+    const __m512i one = _mm512_set1_epi64(1);
+    __m512i end = zero;
+    __m512i sum[2] = {zero, zero}, minSum[2] = {zero, zero}, minFrom[2] = {zero, zero};
+    __m512i best[2] = {_mm512_set1_epi64(LLONG_MIN), _mm512_set1_epi64(LLONG_MIN)};
+    __m512i bestFrom[2] = {zero, zero}, bestTo[2] = {zero, zero};
+    const int32_t *row = values + s;
+    for (unsigned long long t = 0; t < length; t++, row += series)
+    {
+      end = _mm512_add_epi64(end, one);
+      BATCH_STEP_512(0, _mm512_cvtepi32_epi64(_mm256_loadu_si256((const __m256i *)row)));
+      BATCH_STEP_512(1, _mm512_cvtepi32_epi64(_mm256_loadu_si256((const __m256i *)(row + 8))));
+    }
+    for (unsigned k = 0; k < 2; k++)
+    {
+      _mm512_storeu_si512(bestOut + s + 8 * k, best[k]);
+      _mm512_storeu_si512(from + s + 8 * k, bestFrom[k]);
+      _mm512_storeu_si512(to + s + 8 * k, bestTo[k]);
+    }
+  }
+  batchScalar(values, series, length, s, series, bestOut, from, to);
+}
+
+#define BATCH_STEP_256(k, x)                                                   \
+  {                                                                            \
+    sum[k] = _mm256_add_epi64(sum[k], (x));                                    \
+    __m256i candidate = _mm256_sub_epi64(sum[k], minSum[k]);                   \
+    __m256i better = _mm256_cmpgt_epi64(candidate, best[k]);                   \
+    best[k] = _mm256_blendv_epi8(best[k], candidate, better);                  \
+    bestFrom[k] = _mm256_blendv_epi8(bestFrom[k], minFrom[k], better);         \
+    bestTo[k] = _mm256_blendv_epi8(bestTo[k], end, better);                    \
+    __m256i lower = _mm256_cmpgt_epi64(minSum[k], sum[k]);                     \
+    minSum[k] = _mm256_blendv_epi8(minSum[k], sum[k], lower);                  \
+    minFrom[k] = _mm256_blendv_epi8(minFrom[k], end, lower);                   \
+  }
+
+// Eight series at a time in two registers of four 64-bit lanes
+__attribute__((target("avx2"))) static void batchAvx2(const int32_t *values, unsigned long long series,
+                                                      unsigned long long length, long long *bestOut,
+                                                      unsigned long long *from, unsigned long long *to)
+{
+  unsigned long long s = 0;
+  for (; s + 8 <= series; s += 8)
+  {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi64x(1);
+    __m256i end = zero;
+    __m256i sum[2] = {zero, zero}, minSum[2] = {zero, zero}, minFrom[2] = {zero, zero};
+    __m256i best[2] = {_mm256_set1_epi64x(LLONG_MIN), _mm256_set1_epi64x(LLONG_MIN)};
+    __m256i bestFrom[2] = {zero, zero}, bestTo[2] = {zero, zero};
+    const int32_t *row = values + s;
+    for (unsigned long long t = 0; t < length; t++, row += series)
+    {
+      end = _mm256_add_epi64(end, one);
+      BATCH_STEP_256(0, _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i *)row)));
+      BATCH_STEP_256(1, _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i *)(row + 4))));
+    }
+    for (unsigned k = 0; k < 2; k++)
+    {
+      _mm256_storeu_si256((__m256i *)(bestOut + s + 4 * k), best[k]);
+      _mm256_storeu_si256((__m256i *)(from + s + 4 * k), bestFrom[k]);
+      _mm256_storeu_si256((__m256i *)(to + s + 4 * k), bestTo[k]);
+    }
+  }
+  batchScalar(values, series, length, s, series, bestOut, from, to);
+}
+
+#endif
+
+//* Maximum subarray of every series of a column-major block in one pass.
+// values[t * series + s] is the t-th of the `length` elements of series s, so neighbouring series sit in
+// neighbouring SIMD lanes. best[s] is the sum of the maximum subarray [from[s], to[s]) of series s.
+void maxSubarrayBatch(const int32_t *values, unsigned long long series, unsigned long long length,
+                      long long *best, unsigned long long *from, unsigned long long *to)
+{
+  if (length == 0)
+  {
+    fprintf(stderr, "maxSubarrayBatch: every series needs at least one element\n");
+    exit(EXIT_FAILURE);
+  }
+  switch (cpuIsa())
+  {
+#ifdef MSP_HAVE_X86
+  case MSP_ISA_AVX512:
+    batchAvx512(values, series, length, best, from, to);
+    break;
+  case MSP_ISA_AVX2:
+    batchAvx2(values, series, length, best, from, to);
+    break;
+#endif
+  default:
+    batchScalar(values, series, length, 0, series, best, from, to);
+    break;
+  }
+}
@@ -0,0 +1,224 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <limits.h>
+#include <pthread.h>
+#include "MSP.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MSP_HAVE_X86 1
+#endif
+
+#ifdef MSP_HAVE_X86
+
+// Build the summary of lane `k` from the per-lane scan state stored by a SIMD kernel.
+// Every lane has scanned `len` elements on its own, so all offsets are relative to the lane.
+static SEG laneSeg(long long lanes[][8], unsigned k, unsigned long long len)
+{
+  SEG seg;
+  seg.len = len;
+  seg.total = lanes[0][k];
+  seg.best = lanes[1][k];
+  seg.bestFrom = lanes[2][k];
+  seg.bestTo = lanes[3][k];
+  seg.prefix = lanes[4][k];
+  seg.prefixEnd = lanes[5][k];
+  seg.suffix = lanes[0][k] - lanes[6][k];
+  seg.suffixFrom = lanes[7][k];
+  return seg;
+}
+
+// Split the block into one sub-block per lane, summarise the sub-blocks and the remainder, and merge them
+static SEG mergeLanes(const int32_t *values, unsigned long long count, long long lanes[][8], unsigned width, unsigned long long len)
+{
+  SEG seg = emptySeg();
+  for (unsigned k = 0; k < width; k++)
+  {
+    seg = combineSeg(seg, laneSeg(lanes, k, len));
+  }
+  return combineSeg(seg, scanSeg32Scalar(values + width * len, count - width * len));
+}
+
+// One step of the prefix-sum scan in every lane, exactly as the scalar loop in Segment.c does it
+#define STEP_256(x)                                                 \
+  {                                                                 \
+    sum = _mm256_add_epi64(sum, (x));                               \
+    __m256i candidate = _mm256_sub_epi64(sum, minSum);              \
+    __m256i better = _mm256_cmpgt_epi64(candidate, best);           \
+    best = _mm256_blendv_epi8(best, candidate, better);             \
+    bestFrom = _mm256_blendv_epi8(bestFrom, minFrom, better);       \
+    bestTo = _mm256_blendv_epi8(bestTo, end, better);               \
+    better = _mm256_cmpgt_epi64(sum, prefix);                       \
+    prefix = _mm256_blendv_epi8(prefix, sum, better);               \
+    prefixEnd = _mm256_blendv_epi8(prefixEnd, end, better);         \
+    suffixMin = minSum;                                             \
+    suffixFrom = minFrom;                                           \
+    __m256i lower = _mm256_cmpgt_epi64(minSum, sum);                \
+    minSum = _mm256_blendv_epi8(minSum, sum, lower);                \
+    minFrom = _mm256_blendv_epi8(minFrom, end, lower);              \
+  }
+
+// Four 64-bit lanes, each scanning a quarter of the block.
+// Four elements of every quarter are loaded at once and transposed, so that one register holds
+// the i-th element of each quarter and the prefix sums and running minima advance in all lanes together.
+// (A second group of four lanes would hide more latency, but its state no longer fits in 16 registers.)
+__attribute__((target("avx2"))) static SEG scanSeg32Avx2(const int32_t *values, unsigned long long count)
+{
+  unsigned long long len = count / 16 * 4;
+  if (len == 0)
+  {
+    return scanSeg32Scalar(values, count);
+  }
+
+  const __m256i one = _mm256_set1_epi64x(1);
+  const __m256i zero = _mm256_setzero_si256();
+  __m256i end = zero;
+  __m256i sum = zero, minSum = zero, minFrom = zero, suffixMin = zero, suffixFrom = zero;
+  __m256i bestFrom = zero, bestTo = zero, prefixEnd = zero;
+  __m256i best = _mm256_set1_epi64x(LLONG_MIN), prefix = best;
+
+  for (unsigned long long i = 0; i < len; i += 4)
+  {
+    __m128i q0 = _mm_loadu_si128((const __m128i *)(values + i));
+    __m128i q1 = _mm_loadu_si128((const __m128i *)(values + len + i));
+    __m128i q2 = _mm_loadu_si128((const __m128i *)(values + 2 * len + i));
+    __m128i q3 = _mm_loadu_si128((const __m128i *)(values + 3 * len + i));
+    __m128i t0 = _mm_unpacklo_epi32(q0, q1);
+    __m128i t1 = _mm_unpacklo_epi32(q2, q3);
+    __m128i t2 = _mm_unpackhi_epi32(q0, q1);
+    __m128i t3 = _mm_unpackhi_epi32(q2, q3);
+    __m256i x[4];
+    x[0] = _mm256_cvtepi32_epi64(_mm_unpacklo_epi64(t0, t1));
+    x[1] = _mm256_cvtepi32_epi64(_mm_unpackhi_epi64(t0, t1));
+    x[2] = _mm256_cvtepi32_epi64(_mm_unpacklo_epi64(t2, t3));
+    x[3] = _mm256_cvtepi32_epi64(_mm_unpackhi_epi64(t2, t3));
+    for (unsigned j = 0; j < 4; j++)
+    {
+      end = _mm256_add_epi64(end, one);
+      STEP_256(x[j]);
+    }
+  }
+
+  long long lanes[8][8];
+  _mm256_storeu_si256((__m256i *)lanes[0], sum);
+  _mm256_storeu_si256((__m256i *)lanes[1], best);
+  _mm256_storeu_si256((__m256i *)lanes[2], bestFrom);
+  _mm256_storeu_si256((__m256i *)lanes[3], bestTo);
+  _mm256_storeu_si256((__m256i *)lanes[4], prefix);
+  _mm256_storeu_si256((__m256i *)lanes[5], prefixEnd);
+  _mm256_storeu_si256((__m256i *)lanes[6], suffixMin);
+  _mm256_storeu_si256((__m256i *)lanes[7], suffixFrom);
+  return mergeLanes(values, count, lanes, 4, len);
+}
+
+#define STEP_512(x)                                                    \
+  {                                                                    \
+    sum = _mm512_add_epi64(sum, (x));                                  \
+    end = _mm512_add_epi64(end, one);                                  \
+    __m512i candidate = _mm512_sub_epi64(sum, minSum);                 \
+    __mmask8 better = _mm512_cmpgt_epi64_mask(candidate, best);        \
+    best = _mm512_mask_mov_epi64(best, better, candidate);             \
+    bestFrom = _mm512_mask_mov_epi64(bestFrom, better, minFrom);       \
+    bestTo = _mm512_mask_mov_epi64(bestTo, better, end);               \
+    better = _mm512_cmpgt_epi64_mask(sum, prefix);                     \
+    prefix = _mm512_mask_mov_epi64(prefix, better, sum);               \
+    prefixEnd = _mm512_mask_mov_epi64(prefixEnd, better, end);         \
+    suffixMin = minSum;                                                \
+    suffixFrom = minFrom;                                              \
+    __mmask8 lower = _mm512_cmplt_epi64_mask(sum, minSum);             \
+    minSum = _mm512_mask_mov_epi64(minSum, lower, sum);                \
+    minFrom = _mm512_mask_mov_epi64(minFrom, lower, end);              \
+  }
+
+// The same scan as scanSeg32Avx2 with eight lanes, i.e. eight sub-blocks, and mask registers instead of blends.
+// A 4x4 transpose of each half of the lanes feeds four steps per iteration.
+__attribute__((target("avx512f"))) static SEG scanSeg32Avx512(const int32_t *values, unsigned long long count)
+{
+  unsigned long long len = count / 32 * 4;
+  if (len == 0)
+  {
+    return scanSeg32Scalar(values, count);
+  }
+
+  const __m512i one = _mm512_set1_epi64(1);
+  __m512i sum = _mm512_setzero_si512();
+  __m512i end = _mm512_setzero_si512();
+  __m512i minSum = sum, minFrom = sum, suffixMin = sum, suffixFrom = sum;
+  __m512i best = _mm512_set1_epi64(LLONG_MIN), bestFrom = sum, bestTo = sum;
+  __m512i prefix = best, prefixEnd = sum;
+
+  for (unsigned long long i = 0; i < len; i += 4)
+  {
+    __m256i q0 = _mm256_setr_m128i(_mm_loadu_si128((const __m128i *)(values + i)),
+                                   _mm_loadu_si128((const __m128i *)(values + 4 * len + i)));
+    __m256i q1 = _mm256_setr_m128i(_mm_loadu_si128((const __m128i *)(values + len + i)),
+                                   _mm_loadu_si128((const __m128i *)(values + 5 * len + i)));
+    __m256i q2 = _mm256_setr_m128i(_mm_loadu_si128((const __m128i *)(values + 2 * len + i)),
+                                   _mm_loadu_si128((const __m128i *)(values + 6 * len + i)));
+    __m256i q3 = _mm256_setr_m128i(_mm_loadu_si128((const __m128i *)(values + 3 * len + i)),
+                                   _mm_loadu_si128((const __m128i *)(values + 7 * len + i)));
+    // Each 128-bit half is transposed on its own: lanes 0-3 in the low half, lanes 4-7 in the high half
+    __m256i t0 = _mm256_unpacklo_epi32(q0, q1);
+    __m256i t1 = _mm256_unpacklo_epi32(q2, q3);
+    __m256i t2 = _mm256_unpackhi_epi32(q0, q1);
+    __m256i t3 = _mm256_unpackhi_epi32(q2, q3);
+    STEP_512(_mm512_cvtepi32_epi64(_mm256_unpacklo_epi64(t0, t1)));
+    STEP_512(_mm512_cvtepi32_epi64(_mm256_unpackhi_epi64(t0, t1)));
+    STEP_512(_mm512_cvtepi32_epi64(_mm256_unpacklo_epi64(t2, t3)));
+    STEP_512(_mm512_cvtepi32_epi64(_mm256_unpackhi_epi64(t2, t3)));
+  }
+
+  long long lanes[8][8];
+  _mm512_storeu_si512(lanes[0], sum);
+  _mm512_storeu_si512(lanes[1], best);
+  _mm512_storeu_si512(lanes[2], bestFrom);
+  _mm512_storeu_si512(lanes[3], bestTo);
+  _mm512_storeu_si512(lanes[4], prefix);
+  _mm512_storeu_si512(lanes[5], prefixEnd);
+  _mm512_storeu_si512(lanes[6], suffixMin);
+  _mm512_storeu_si512(lanes[7], suffixFrom);
+  return mergeLanes(values, count, lanes, 8, len);
+}
+
+#endif
+
+static pthread_once_t isaOnce = PTHREAD_ONCE_INIT;
+static MSPIsa isa = MSP_ISA_SCALAR;
+
+static void detectIsa(void)
+{
+#ifdef MSP_HAVE_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f"))
+  {
+    isa = MSP_ISA_AVX512;
+  }
+  else if (__builtin_cpu_supports("avx2"))
+  {
+    isa = MSP_ISA_AVX2;
+  }
+#endif
+}
+
+//* Widest instruction set the CPU supports. It is detected on the first call, once even if threads race to make it.
+MSPIsa cpuIsa(void)
+{
+  pthread_once(&isaOnce, detectIsa);
+  return isa;
+}
+
+//* Summarise a block of int32 values with the fastest kernel available on this CPU
+SEG scanSeg32(const int32_t *values, unsigned long long count)
+{
+  switch (cpuIsa())
+  {
+#ifdef MSP_HAVE_X86
+  case MSP_ISA_AVX512:
+    return scanSeg32Avx512(values, count);
+  case MSP_ISA_AVX2:
+    return scanSeg32Avx2(values, count);
+#endif
+  default:
+    return scanSeg32Scalar(values, count);
+  }
+}
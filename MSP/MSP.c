@@ -1,5 +1,7 @@
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <unistd.h>
 #include "MSP.h"
 #define INT_MIN -2147483648
 
@@ -7,9 +9,120 @@
 extern unsigned num;
 extern int data[];
 
-int main()
+static void printSeg(SEG seg)
 {
-  printf("%d\n", maxSubarray(0, num));
+  if (seg.len == 0)
+  {
+    puts("no data");
+    return;
+  }
+  printf("%lld [%llu, %llu)\n", seg.best, seg.bestFrom, seg.bestTo);
+}
+
+static void printRange(RANGE range)
+{
+  printf("%lld [%llu, %llu)\n", range.sum, range.from, range.to);
+}
+
+// Usage:
+//   ./msp.out                         maximum subarray of the compiled-in data
+//   ./msp.out [OPTIONS] FILE          maximum subarray of a binary file of int32 values
+//   ./msp.out [OPTIONS] -             the same, read from the standard input
+// Options:
+//   -64                 the values are int64
+//   -len MIN MAX        only subarrays whose length lies in [MIN, MAX]
+//   -circular           the input is a circular buffer; [from, to) with to <= from wraps around
+int main(int argc, char *argv[])
+{
+  if (argc < 2)
+  {
+    printf("%d\n", maxSubarray(0, num));
+    return 0;
+  }
+
+  MSPType type = MSP_INT32;
+  unsigned long long minLen = 0, maxLen = 0;
+  int circular = 0;
+  int arg = 1;
+  for (; arg < argc - 1; arg++)
+  {
+    if (strcmp(argv[arg], "-64") == 0)
+    {
+      type = MSP_INT64;
+    }
+    else if (strcmp(argv[arg], "-circular") == 0)
+    {
+      circular = 1;
+    }
+    else if (strcmp(argv[arg], "-len") == 0 && arg + 3 < argc)
+    {
+      minLen = strtoull(argv[++arg], NULL, 10);
+      maxLen = strtoull(argv[++arg], NULL, 10);
+    }
+    else
+    {
+      break;
+    }
+  }
+  if (arg != argc - 1)
+  {
+    fprintf(stderr, "usage: %s [-64] [-len MIN MAX | -circular] FILE|-\n", argv[0]);
+    return 1;
+  }
+  const char *path = argv[arg];
+  int useStdin = strcmp(path, "-") == 0;
+
+  if (maxLen > 0)
+  {
+    LENSCAN *scan = newLenScan(minLen, maxLen);
+    if (useStdin)
+    {
+      readChunks(STDIN_FILENO, type, feedLenScan, scan);
+    }
+    else
+    {
+      mapChunks(path, type, feedLenScan, scan);
+    }
+    if (scan->best.to == 0)
+    {
+      puts("no subarray of such a length");
+    }
+    else
+    {
+      printRange(scan->best);
+    }
+    freeLenScan(scan);
+  }
+  else if (circular)
+  {
+    CIRCSCAN *scan = newCircScan();
+    if (useStdin)
+    {
+      readChunks(STDIN_FILENO, type, feedCircScan, scan);
+    }
+    else
+    {
+      mapChunks(path, type, feedCircScan, scan);
+    }
+    if (scan->seg.len == 0)
+    {
+      puts("no data");
+    }
+    else
+    {
+      printRange(resultCircScan(scan));
+    }
+    freeCircScan(scan);
+  }
+  else if (useStdin)
+  {
+    printSeg(maxSubarrayFd(STDIN_FILENO, type));
+  }
+  else
+  {
+    printSeg(maxSubarrayFile(path, type));
+  }
+  return 0;
 }
 
 int maxSubarray(unsigned from, unsigned num)
@@ -1,2 +1,161 @@
+#include <stdint.h>
+
 int maxSubarray(unsigned from, unsigned num);
 
+// Summary of a contiguous segment of values.
+// Every offset is relative to the first element of the segment, and every range is half-open [from, to).
+// Two adjacent summaries can be merged with combineSeg, so the summary of a long input can be built from the
+// summaries of its chunks without keeping the chunks themselves.
+typedef struct
+{
+  unsigned long long len; // number of elements
+  long long total;        // sum of all elements
+  long long prefix;       // maximum sum of a non-empty prefix [0, prefixEnd)
+  long long suffix;       // maximum sum of a non-empty suffix [suffixFrom, len)
+  long long best;         // maximum sum of a non-empty subarray [bestFrom, bestTo)
+  unsigned long long prefixEnd;
+  unsigned long long suffixFrom;
+  unsigned long long bestFrom;
+  unsigned long long bestTo;
+} SEG;
+
+// A subarray [from, to) and its sum
+typedef struct
+{
+  long long sum;
+  unsigned long long from;
+  unsigned long long to;
+} RANGE;
+
+// Element type of a binary input
+typedef enum
+{
+  MSP_INT32,
+  MSP_INT64
+} MSPType;
+
+// Callback which receives the input chunk by chunk.
+// `values` points to `count` elements of the given type.
+typedef void (*MSPChunkFn)(const void *values, unsigned long long count, MSPType type, void *ctx);
+
+SEG emptySeg(void);
+SEG leafSeg(long long value);
+SEG combineSeg(SEG left, SEG right);
+void shiftSeg(SEG *seg, unsigned long long offset);
+int isBetter(long long sum1, unsigned long long from1, unsigned long long to1,
+             long long sum2, unsigned long long from2, unsigned long long to2);
+// Instruction sets the kernels are built for
+typedef enum
+{
+  MSP_ISA_SCALAR,
+  MSP_ISA_AVX2,
+  MSP_ISA_AVX512
+} MSPIsa;
+
+MSPIsa cpuIsa(void);
+SEG scanSeg32(const int32_t *values, unsigned long long count);
+SEG scanSeg32Scalar(const int32_t *values, unsigned long long count);
+SEG scanSeg64(const int64_t *values, unsigned long long count);
+
+void readChunks(int fd, MSPType type, MSPChunkFn fn, void *ctx);
+void mapChunks(const char *path, MSPType type, MSPChunkFn fn, void *ctx);
+SEG maxSubarrayFd(int fd, MSPType type);
+SEG maxSubarrayFile(const char *path, MSPType type);
+
+// Smallest number of elements worth a thread of its own
+#define MSP_MIN_CHUNK (1 << 16)
+
+unsigned defaultThreads(void);
+SEG maxSubarrayParallel(const int32_t *values, unsigned long long count, unsigned threads);
+
+// Number of elements summarised by a leaf of the segment tree
+#define MSP_TREE_BLOCK 64
+
+// Segment tree over a series which answers "maximum subarray inside [from, to)" and takes point updates in O(log n).
+// Every node keeps the SEG of its range; the leaves summarise blocks of MSP_TREE_BLOCK elements.
+typedef struct
+{
+  unsigned long long num;  // number of elements
+  unsigned long long size; // number of leaves, a power of two
+  int32_t *val;            // copy of the elements
+  SEG *node;               // node[1] is the root and node[size + b] is the leaf of block b
+} SEGTREE;
+
+SEGTREE *newSegTree(const int32_t *values, unsigned long long num);
+void freeSegTree(SEGTREE *tree);
+void updateSegTree(SEGTREE *tree, unsigned long long pos, int32_t value);
+SEG querySegTree(SEGTREE *tree, unsigned long long from, unsigned long long to);
+void querySegTreeBatch(SEGTREE *tree, const unsigned long long *from, const unsigned long long *to, SEG *result,
+                       unsigned long long count, unsigned threads);
+unsigned long long topSubarrays(SEGTREE *tree, unsigned long long k, RANGE *result);
+
+// Maximum subarray of the last `capacity` samples of a live series.
+// The window is a queue made of two stacks: the newest samples are pushed on `back`, which only keeps their
+// combined summary, and `front` holds the oldest samples, each with the summary from itself to the newest sample
+// of the front stack. Pushing, evicting and asking for the best subarray are amortised O(1).
+typedef struct
+{
+  unsigned long long capacity; // window length W
+  unsigned long long pushed;   // number of samples pushed since the window was created
+  SEG *front;                  // front[frontNum - 1] is the oldest sample and summarises the whole front stack
+  unsigned long long frontNum;
+  long long *back;             // back[backNum - 1] is the newest sample
+  unsigned long long backNum;
+  SEG backSeg;                 // summary of back[0 .. backNum)
+} WINDOW;
+
+WINDOW *newWindow(unsigned long long capacity);
+void freeWindow(WINDOW *win);
+void pushWindow(WINDOW *win, long long value);
+void evictWindow(WINDOW *win);
+unsigned long long sizeWindow(WINDOW *win);
+SEG bestWindow(WINDOW *win);
+
+void maxSubarrayBatch(const int32_t *values, unsigned long long series, unsigned long long length,
+                      long long *best, unsigned long long *from, unsigned long long *to);
+
+// Maximum subarray whose length lies in [minLen, maxLen], fed chunk by chunk (see MSPChunkFn).
+// The candidate beginnings form a monotonic deque of prefix sums, so the scan is O(n) with O(maxLen) memory.
+typedef struct
+{
+  unsigned long long minLen;
+  unsigned long long maxLen;
+  unsigned long long count;   // number of elements fed so far
+  long long sum;              // prefix sum of everything fed so far
+  long long *history;         // the last minLen + 1 prefix sums, history[k % (minLen + 1)] = P[k]
+  long long *dequeSum;        // ring buffer of candidate beginnings with increasing prefix sums
+  unsigned long long *dequePos;
+  unsigned long long dequeHead;
+  unsigned long long dequeNum;
+  RANGE best;                 // best.to == 0 until a subarray of a valid length has been seen
+} LENSCAN;
+
+LENSCAN *newLenScan(unsigned long long minLen, unsigned long long maxLen);
+void freeLenScan(LENSCAN *scan);
+void feedLenScan(const void *values, unsigned long long count, MSPType type, void *ctx);
+
+// Maximum subarray of a circular buffer, fed chunk by chunk (see MSPChunkFn), in constant memory.
+// A subarray which wraps around is the complement of a subarray with the minimum sum.
+typedef struct
+{
+  SEG seg;                 // summary of the input without wrapping
+  long long sum;           // prefix sum of everything fed so far
+  long long maxSum;        // largest prefix sum so far, P[0] = 0 included
+  unsigned long long maxPos;
+  RANGE worst;             // subarray with the minimum sum
+} CIRCSCAN;
+
+CIRCSCAN *newCircScan(void);
+void freeCircScan(CIRCSCAN *scan);
+void feedCircScan(const void *values, unsigned long long count, MSPType type, void *ctx);
+RANGE resultCircScan(CIRCSCAN *scan);
+
+// A run of `count` copies of `value` in run-length encoded input
+typedef struct
+{
+  long long value;
+  unsigned long long count;
+} RUN;
+
+SEG runSeg(long long value, unsigned long long count);
+SEG maxSubarrayRLE(const RUN *runs, unsigned long long num);
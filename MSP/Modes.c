@@ -0,0 +1,186 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <limits.h>
+#include "MSP.h"
+
+static void errorModes(char *str)
+{
+  fprintf(stderr, "%s\n", str);
+  exit(EXIT_FAILURE);
+}
+
+LENSCAN *newLenScan(unsigned long long minLen, unsigned long long maxLen)
+{
+  if (minLen == 0 || minLen > maxLen)
+  {
+    errorModes("newLenScan: the lengths must satisfy 1 <= minLen <= maxLen");
+  }
+  LENSCAN *scan;
+  if ((scan = (LENSCAN *)malloc(sizeof(LENSCAN))) == NULL)
+  {
+    errorModes("newLenScan: no more memory");
+  }
+  scan->minLen = minLen;
+  scan->maxLen = maxLen;
+  scan->count = 0;
+  scan->sum = 0;
+  scan->history = (long long *)malloc(sizeof(long long) * (minLen + 1));
+  scan->dequeSum = (long long *)malloc(sizeof(long long) * (maxLen - minLen + 1));
+  scan->dequePos = (unsigned long long *)malloc(sizeof(unsigned long long) * (maxLen - minLen + 1));
+  if (scan->history == NULL || scan->dequeSum == NULL || scan->dequePos == NULL)
+  {
+    errorModes("newLenScan: too large");
+  }
+  scan->history[0] = 0;
+  scan->dequeHead = 0;
+  scan->dequeNum = 0;
+  scan->best.sum = 0;
+  scan->best.from = 0;
+  scan->best.to = 0;
+  return scan;
+}
+
+void freeLenScan(LENSCAN *scan)
+{
+  free(scan->history);
+  free(scan->dequeSum);
+  free(scan->dequePos);
+  free(scan);
+}
+
+// Consume one element. After it P[i] is known, and the beginnings j with i - maxLen <= j <= i - minLen are valid.
+static void stepLenScan(LENSCAN *scan, long long value)
+{
+  unsigned long long ring = scan->maxLen - scan->minLen + 1;
+  scan->sum += value;
+  unsigned long long i = ++scan->count;
+  scan->history[i % (scan->minLen + 1)] = scan->sum;
+  if (i < scan->minLen)
+  {
+    return;
+  }
+
+  // Beginnings further than maxLen away expire
+  while (scan->dequeNum > 0 && scan->dequePos[scan->dequeHead] + scan->maxLen < i)
+  {
+    scan->dequeHead = (scan->dequeHead + 1) % ring;
+    scan->dequeNum--;
+  }
+  // j = i - minLen has just become a valid beginning. Larger prefix sums behind it can never be the minimum
+  // again; equal ones are kept so that the earliest beginning wins ties.
+  unsigned long long j = i - scan->minLen;
+  long long sumJ = scan->history[j % (scan->minLen + 1)];
+  while (scan->dequeNum > 0 && scan->dequeSum[(scan->dequeHead + scan->dequeNum - 1) % ring] > sumJ)
+  {
+    scan->dequeNum--;
+  }
+  scan->dequeSum[(scan->dequeHead + scan->dequeNum) % ring] = sumJ;
+  scan->dequePos[(scan->dequeHead + scan->dequeNum) % ring] = j;
+  scan->dequeNum++;
+
+  long long candidate = scan->sum - scan->dequeSum[scan->dequeHead];
+  if (scan->best.to == 0 || candidate > scan->best.sum)
+  {
+    scan->best.sum = candidate;
+    scan->best.from = scan->dequePos[scan->dequeHead];
+    scan->best.to = i;
+  }
+}
+
+//* Feed a chunk of values to a LENSCAN passed as `ctx`
+void feedLenScan(const void *values, unsigned long long count, MSPType type, void *ctx)
+{
+  LENSCAN *scan = (LENSCAN *)ctx;
+  if (type == MSP_INT64)
+  {
+    for (unsigned long long i = 0; i < count; i++)
+    {
+      stepLenScan(scan, ((const int64_t *)values)[i]);
+    }
+  }
+  else
+  {
+    for (unsigned long long i = 0; i < count; i++)
+    {
+      stepLenScan(scan, ((const int32_t *)values)[i]);
+    }
+  }
+}
+
+CIRCSCAN *newCircScan(void)
+{
+  CIRCSCAN *scan;
+  if ((scan = (CIRCSCAN *)malloc(sizeof(CIRCSCAN))) == NULL)
+  {
+    errorModes("newCircScan: no more memory");
+  }
+  scan->seg = emptySeg();
+  scan->sum = 0;
+  scan->maxSum = 0;
+  scan->maxPos = 0;
+  scan->worst.sum = LLONG_MAX;
+  scan->worst.from = 0;
+  scan->worst.to = 0;
+  return scan;
+}
+
+void freeCircScan(CIRCSCAN *scan)
+{
+  free(scan);
+}
+
+// The subarray ending at i with the minimum sum is P[i] - max{P[j] | j < i}
+#define CIRC_LOOP(type)                                  \
+  for (unsigned long long i = 0; i < count; i++)         \
+  {                                                      \
+    scan->sum += ((const type *)values)[i];              \
+    if (scan->sum - scan->maxSum < scan->worst.sum)      \
+    {                                                    \
+      scan->worst.sum = scan->sum - scan->maxSum;        \
+      scan->worst.from = scan->maxPos;                   \
+      scan->worst.to = base + i + 1;                     \
+    }                                                    \
+    if (scan->sum > scan->maxSum)                        \
+    {                                                    \
+      scan->maxSum = scan->sum;                          \
+      scan->maxPos = base + i + 1;                       \
+    }                                                    \
+  }
+
+//* Feed a chunk of values to a CIRCSCAN passed as `ctx`
+void feedCircScan(const void *values, unsigned long long count, MSPType type, void *ctx)
+{
+  CIRCSCAN *scan = (CIRCSCAN *)ctx;
+  unsigned long long base = scan->seg.len;
+  if (type == MSP_INT64)
+  {
+    scan->seg = combineSeg(scan->seg, scanSeg64((const int64_t *)values, count));
+    CIRC_LOOP(int64_t)
+  }
+  else
+  {
+    scan->seg = combineSeg(scan->seg, scanSeg32((const int32_t *)values, count));
+    CIRC_LOOP(int32_t)
+  }
+}
+
+//* Best subarray of the circular buffer fed so far. When to <= from the subarray wraps around,
+// i.e. it is [from, n) followed by [0, to).
+RANGE resultCircScan(CIRCSCAN *scan)
+{
+  RANGE range = {scan->seg.best, scan->seg.bestFrom, scan->seg.bestTo};
+  unsigned long long n = scan->seg.len;
+  // Dropping the whole input leaves nothing, and a complement touching an end does not wrap,
+  // so both are already covered by the plain maximum subarray
+  if (scan->worst.from == 0 || scan->worst.to == n)
+  {
+    return range;
+  }
+  if (scan->seg.total - scan->worst.sum > range.sum)
+  {
+    range.sum = scan->seg.total - scan->worst.sum;
+    range.from = scan->worst.to;
+    range.to = scan->worst.from;
+  }
+  return range;
+}
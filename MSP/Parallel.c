@@ -0,0 +1,94 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "MSP.h"
+
+// Work of a single thread: summarise values[from, from + count)
+typedef struct
+{
+  const int32_t *values;
+  unsigned long long from;
+  unsigned long long count;
+  SEG seg;
+} MSPWork;
+
+static void *scanWork(void *arg)
+{
+  MSPWork *work = (MSPWork *)arg;
+  work->seg = scanSeg32(work->values + work->from, work->count);
+  return NULL;
+}
+
+//* Number of threads to use when the caller passes 0
+unsigned defaultThreads(void)
+{
+  long online = sysconf(_SC_NPROCESSORS_ONLN);
+  return online > 0 ? (unsigned)online : 1;
+}
+
+//* Find the maximum subarray with `threads` threads (0 means one per online core) in O(n) total work.
+// Each thread summarises one contiguous chunk, then the summaries are merged pairwise in a balanced tree.
+SEG maxSubarrayParallel(const int32_t *values, unsigned long long count, unsigned threads)
+{
+  if (threads == 0)
+  {
+    threads = defaultThreads();
+  }
+  // Do not start threads for chunks which are cheaper to scan than to hand over
+  if (count / MSP_MIN_CHUNK < threads)
+  {
+    threads = (unsigned)(count / MSP_MIN_CHUNK);
+  }
+  if (threads <= 1)
+  {
+    return scanSeg32(values, count);
+  }
+
+  MSPWork *works = (MSPWork *)malloc(sizeof(MSPWork) * threads);
+  pthread_t *ids = (pthread_t *)malloc(sizeof(pthread_t) * threads);
+  if (works == NULL || ids == NULL)
+  {
+    perror("maxSubarrayParallel: no more memory");
+    exit(EXIT_FAILURE);
+  }
+
+  // Split the input into chunks whose borders are aligned to cache lines
+  unsigned long long step = (count / threads + 15) & ~15ULL;
+  for (unsigned t = 0; t < threads; t++)
+  {
+    unsigned long long from = step * t < count ? step * t : count;
+    unsigned long long to = from + step < count && t + 1 < threads ? from + step : count;
+    works[t].values = values;
+    works[t].from = from;
+    works[t].count = to - from;
+  }
+  // The calling thread takes the first chunk itself
+  for (unsigned t = 1; t < threads; t++)
+  {
+    if (pthread_create(&ids[t], NULL, scanWork, &works[t]) != 0)
+    {
+      perror("maxSubarrayParallel: cannot create a thread");
+      exit(EXIT_FAILURE);
+    }
+  }
+  scanWork(&works[0]);
+  for (unsigned t = 1; t < threads; t++)
+  {
+    pthread_join(ids[t], NULL);
+  }
+
+  // Merge neighbouring summaries level by level: (0,1) (2,3) ... then (0,2) (4,6) ...
+  for (unsigned width = 1; width < threads; width *= 2)
+  {
+    for (unsigned t = 0; t + width < threads; t += 2 * width)
+    {
+      works[t].seg = combineSeg(works[t].seg, works[t + width].seg);
+    }
+  }
+
+  SEG seg = works[0].seg;
+  free(works);
+  free(ids);
+  return seg;
+}
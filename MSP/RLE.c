@@ -0,0 +1,52 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include "MSP.h"
+
+//* Summary of `count` copies of `value` in O(1), identical to scanning the expanded run.
+// A positive run is best taken whole; otherwise a single element is best (the first one, or for the
+// suffix of a negative run the last one).
+SEG runSeg(long long value, unsigned long long count)
+{
+  if (count == 0)
+  {
+    return emptySeg();
+  }
+
+  SEG seg;
+  seg.len = count;
+  seg.total = value * (long long)count;
+  if (value > 0)
+  {
+    seg.prefix = seg.suffix = seg.best = seg.total;
+    seg.prefixEnd = seg.bestTo = count;
+    seg.suffixFrom = seg.bestFrom = 0;
+    return seg;
+  }
+
+  seg.prefix = seg.best = value;
+  seg.prefixEnd = seg.bestTo = 1;
+  seg.bestFrom = 0;
+  if (value == 0)
+  {
+    seg.suffix = 0;
+    seg.suffixFrom = 0;
+  }
+  else
+  {
+    seg.suffix = value;
+    seg.suffixFrom = count - 1;
+  }
+  return seg;
+}
+
+//* Maximum subarray of a run-length encoded series in O(number of runs).
+// The offsets in the result refer to the expanded series.
+SEG maxSubarrayRLE(const RUN *runs, unsigned long long num)
+{
+  SEG seg = emptySeg();
+  for (unsigned long long i = 0; i < num; i++)
+  {
+    seg = combineSeg(seg, runSeg(runs[i].value, runs[i].count));
+  }
+  return seg;
+}
@@ -0,0 +1,173 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <pthread.h>
+#include "MSP.h"
+#include "Rect.h"
+
+static void errorRect(char *str)
+{
+  fprintf(stderr, "%s\n", str);
+  exit(EXIT_FAILURE);
+}
+
+// Work of a single thread: every band whose top row is first, first + step, first + 2 * step, ...
+// `v` is a rows x cols row-major matrix whose rows start `stride` elements apart: the input itself, which may be a view,
+// or its contiguous transpose when the input has more rows than columns.
+typedef struct
+{
+  const int *v;
+  unsigned rows;
+  unsigned cols;
+  unsigned stride;
+  unsigned first;
+  unsigned step;
+  RECT rect;
+} RECTWORK;
+
+// Larger sums win; ties go to the band starting (then ending) first and then to the order of isBetter
+static int isBetterRect(RECT a, RECT b)
+{
+  if (a.sum != b.sum)
+  {
+    return a.sum > b.sum;
+  }
+  if (a.top != b.top)
+  {
+    return a.top < b.top;
+  }
+  if (a.bottom != b.bottom)
+  {
+    return a.bottom < b.bottom;
+  }
+  return isBetter(a.sum, a.left, a.right, b.sum, b.left, b.right);
+}
+
+static void *rectWork(void *arg)
+{
+  RECTWORK *work = (RECTWORK *)arg;
+  int64_t *columnSum = (int64_t *)malloc(sizeof(int64_t) * work->cols);
+  if (columnSum == NULL)
+  {
+    errorRect("maxSubrectangle: no more memory");
+  }
+
+  int found = 0;
+  for (unsigned top = work->first; top < work->rows; top += work->step)
+  {
+    // Compress the band [top, bottom) into one row of column sums, growing it one row at a time,
+    // and solve the 1D problem on the compressed row
+    for (unsigned c = 0; c < work->cols; c++)
+    {
+      columnSum[c] = 0;
+    }
+    for (unsigned bottom = top; bottom < work->rows; bottom++)
+    {
+      const int *row = work->v + (unsigned long long)bottom * work->stride;
+      for (unsigned c = 0; c < work->cols; c++)
+      {
+        columnSum[c] += row[c];
+      }
+      SEG seg = scanSeg64(columnSum, work->cols);
+      RECT rect = {seg.best, top, bottom + 1, (unsigned)seg.bestFrom, (unsigned)seg.bestTo};
+      if (!found || isBetterRect(rect, work->rect))
+      {
+        work->rect = rect;
+        found = 1;
+      }
+    }
+  }
+  free(columnSum);
+  return NULL;
+}
+
+//* Find the sub-rectangle of `mat` with the maximum sum in O(min(x, y)^2 * max(x, y)).
+// Pairs of rows are taken along the shorter side (the matrix is transposed once if needed), and the
+// bands are distributed over `threads` threads (0 means one per core).
+RECT maxSubrectangle(MAT *mat, unsigned threads)
+{
+  if (mat->x == 0 || mat->y == 0)
+  {
+    errorRect("maxSubrectangle: the matrix is empty");
+  }
+
+  const int *v = mat->v;
+  unsigned rows = mat->x;
+  unsigned cols = mat->y;
+  unsigned stride = mat->stride;
+  int *transposed = NULL;
+  if (rows > cols)
+  {
+    if ((transposed = (int *)malloc(sizeof(int) * rows * cols)) == NULL)
+    {
+      errorRect("maxSubrectangle: no more memory");
+    }
+    for (unsigned i = 0; i < rows; i++)
+    {
+      for (unsigned j = 0; j < cols; j++)
+      {
+        transposed[(unsigned long long)j * rows + i] = mat->v[(unsigned long long)i * mat->stride + j];
+      }
+    }
+    v = transposed;
+    rows = mat->y;
+    cols = mat->x;
+    stride = cols;
+  }
+
+  if (threads == 0)
+  {
+    threads = defaultThreads();
+  }
+  if (threads > rows)
+  {
+    threads = rows;
+  }
+  RECTWORK *works = (RECTWORK *)malloc(sizeof(RECTWORK) * threads);
+  pthread_t *ids = (pthread_t *)malloc(sizeof(pthread_t) * threads);
+  if (works == NULL || ids == NULL)
+  {
+    errorRect("maxSubrectangle: no more memory");
+  }
+  // Bands starting near the top are the longest, so the top rows are dealt out round robin
+  for (unsigned t = 0; t < threads; t++)
+  {
+    works[t].v = v;
+    works[t].rows = rows;
+    works[t].cols = cols;
+    works[t].stride = stride;
+    works[t].first = t;
+    works[t].step = threads;
+  }
+  for (unsigned t = 1; t < threads; t++)
+  {
+    if (pthread_create(&ids[t], NULL, rectWork, &works[t]) != 0)
+    {
+      errorRect("maxSubrectangle: cannot create a thread");
+    }
+  }
+  rectWork(&works[0]);
+  for (unsigned t = 1; t < threads; t++)
+  {
+    pthread_join(ids[t], NULL);
+  }
+
+  RECT rect = works[0].rect;
+  for (unsigned t = 1; t < threads; t++)
+  {
+    if (isBetterRect(works[t].rect, rect))
+    {
+      rect = works[t].rect;
+    }
+  }
+  free(works);
+  free(ids);
+
+  // Swap the sides back if the bands were taken along the columns
+  if (transposed != NULL)
+  {
+    RECT swapped = {rect.sum, rect.left, rect.right, rect.top, rect.bottom};
+    rect = swapped;
+    free(transposed);
+  }
+  return rect;
+}
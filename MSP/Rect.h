@@ -0,0 +1,13 @@
+#include "../Strassen/Matrix.h"
+
+// Sub-rectangle of a matrix: rows [top, bottom) and columns [left, right)
+typedef struct
+{
+  long long sum;
+  unsigned top;
+  unsigned bottom;
+  unsigned left;
+  unsigned right;
+} RECT;
+
+RECT maxSubrectangle(MAT *mat, unsigned threads);
@@ -0,0 +1,202 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <pthread.h>
+#include "MSP.h"
+
+static void errorSegTree(char *str)
+{
+  fprintf(stderr, "%s\n", str);
+  exit(EXIT_FAILURE);
+}
+
+static unsigned long long blockEnd(SEGTREE *tree, unsigned long long block)
+{
+  unsigned long long end = (block + 1) * MSP_TREE_BLOCK;
+  return end < tree->num ? end : tree->num;
+}
+
+//* Build the index over a copy of `values`.
+// Each leaf summarises a block of MSP_TREE_BLOCK elements, so the tree takes about 2 * 72 bytes per block.
+SEGTREE *newSegTree(const int32_t *values, unsigned long long num)
+{
+  SEGTREE *tree;
+  if ((tree = (SEGTREE *)malloc(sizeof(SEGTREE))) == NULL)
+  {
+    errorSegTree("newSegTree: no more memory");
+  }
+  tree->num = num;
+  unsigned long long blocks = (num + MSP_TREE_BLOCK - 1) / MSP_TREE_BLOCK;
+  tree->size = 1;
+  while (tree->size < blocks)
+  {
+    tree->size *= 2;
+  }
+  tree->val = (int32_t *)malloc(sizeof(int32_t) * (num > 0 ? num : 1));
+  // Unused leaves keep the summary of the empty segment
+  tree->node = (SEG *)calloc(2 * tree->size, sizeof(SEG));
+  if (tree->val == NULL || tree->node == NULL)
+  {
+    errorSegTree("newSegTree: too large");
+  }
+
+  for (unsigned long long i = 0; i < num; i++)
+  {
+    tree->val[i] = values[i];
+  }
+  for (unsigned long long b = 0; b < blocks; b++)
+  {
+    unsigned long long from = b * MSP_TREE_BLOCK;
+    tree->node[tree->size + b] = scanSeg32(tree->val + from, blockEnd(tree, b) - from);
+  }
+  for (unsigned long long k = tree->size - 1; k >= 1; k--)
+  {
+    tree->node[k] = combineSeg(tree->node[2 * k], tree->node[2 * k + 1]);
+  }
+  return tree;
+}
+
+void freeSegTree(SEGTREE *tree)
+{
+  free(tree->val);
+  free(tree->node);
+  free(tree);
+}
+
+//* Replace the element at `pos` and refresh the summaries on the way to the root in O(log n)
+void updateSegTree(SEGTREE *tree, unsigned long long pos, int32_t value)
+{
+  if (pos >= tree->num)
+  {
+    errorSegTree("updateSegTree: pos is out of range");
+  }
+  tree->val[pos] = value;
+
+  unsigned long long block = pos / MSP_TREE_BLOCK;
+  unsigned long long from = block * MSP_TREE_BLOCK;
+  unsigned long long k = tree->size + block;
+  tree->node[k] = scanSeg32(tree->val + from, blockEnd(tree, block) - from);
+  for (k /= 2; k >= 1; k /= 2)
+  {
+    tree->node[k] = combineSeg(tree->node[2 * k], tree->node[2 * k + 1]);
+  }
+}
+
+//* Summary of the elements [from, to) with absolute offsets, in O(log n)
+SEG querySegTree(SEGTREE *tree, unsigned long long from, unsigned long long to)
+{
+  if (to > tree->num)
+  {
+    errorSegTree("querySegTree: to is out of range");
+  }
+  if (from >= to)
+  {
+    return emptySeg();
+  }
+
+  unsigned long long first = from / MSP_TREE_BLOCK;
+  unsigned long long last = (to - 1) / MSP_TREE_BLOCK;
+  SEG seg;
+  if (first == last)
+  {
+    // The range lies in a single block
+    seg = scanSeg32(tree->val + from, to - from);
+  }
+  else
+  {
+    // Partial blocks at both ends are scanned, the whole blocks in between come from the tree
+    SEG left = scanSeg32(tree->val + from, blockEnd(tree, first) - from);
+    SEG right = scanSeg32(tree->val + last * MSP_TREE_BLOCK, to - last * MSP_TREE_BLOCK);
+    unsigned long long l = tree->size + first + 1;
+    unsigned long long r = tree->size + last;
+    while (l < r)
+    {
+      if (l & 1)
+      {
+        left = combineSeg(left, tree->node[l++]);
+      }
+      if (r & 1)
+      {
+        right = combineSeg(tree->node[--r], right);
+      }
+      l /= 2;
+      r /= 2;
+    }
+    seg = combineSeg(left, right);
+  }
+  shiftSeg(&seg, from);
+  return seg;
+}
+
+// Queries answered by a single thread
+typedef struct
+{
+  SEGTREE *tree;
+  const unsigned long long *from;
+  const unsigned long long *to;
+  SEG *result;
+  unsigned long long count;
+} QUERYWORK;
+
+static void *queryWork(void *arg)
+{
+  QUERYWORK *work = (QUERYWORK *)arg;
+  for (unsigned long long q = 0; q < work->count; q++)
+  {
+    work->result[q] = querySegTree(work->tree, work->from[q], work->to[q]);
+  }
+  return NULL;
+}
+
+//* Answer `count` range queries [from[q], to[q]) into result[q] with `threads` threads (0 means one per core).
+// The tree must not be updated while the queries run.
+void querySegTreeBatch(SEGTREE *tree, const unsigned long long *from, const unsigned long long *to, SEG *result,
+                       unsigned long long count, unsigned threads)
+{
+  if (threads == 0)
+  {
+    threads = defaultThreads();
+  }
+  // A query costs a few hundred nanoseconds, so hand out at least a few thousand per thread
+  if (count / 4096 < threads)
+  {
+    threads = (unsigned)(count / 4096);
+  }
+  if (threads <= 1)
+  {
+    QUERYWORK work = {tree, from, to, result, count};
+    queryWork(&work);
+    return;
+  }
+
+  QUERYWORK *works = (QUERYWORK *)malloc(sizeof(QUERYWORK) * threads);
+  pthread_t *ids = (pthread_t *)malloc(sizeof(pthread_t) * threads);
+  if (works == NULL || ids == NULL)
+  {
+    errorSegTree("querySegTreeBatch: no more memory");
+  }
+  unsigned long long step = (count + threads - 1) / threads;
+  for (unsigned t = 0; t < threads; t++)
+  {
+    unsigned long long first = step * t < count ? step * t : count;
+    unsigned long long last = first + step < count ? first + step : count;
+    works[t].tree = tree;
+    works[t].from = from + first;
+    works[t].to = to + first;
+    works[t].result = result + first;
+    works[t].count = last - first;
+  }
+  for (unsigned t = 1; t < threads; t++)
+  {
+    if (pthread_create(&ids[t], NULL, queryWork, &works[t]) != 0)
+    {
+      errorSegTree("querySegTreeBatch: cannot create a thread");
+    }
+  }
+  queryWork(&works[0]);
+  for (unsigned t = 1; t < threads; t++)
+  {
+    pthread_join(ids[t], NULL);
+  }
+  free(works);
+  free(ids);
+}
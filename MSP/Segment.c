@@ -0,0 +1,149 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include "MSP.h"
+
+// Return whether the subarray [from1, to1) with sum1 should be preferred over [from2, to2) with sum2.
+// A larger sum wins; ties are broken by the earlier end and then by the earlier beginning,
+// which is the same order the linear scan below visits the candidates in.
+int isBetter(long long sum1, unsigned long long from1, unsigned long long to1,
+                    long long sum2, unsigned long long from2, unsigned long long to2)
+{
+  if (sum1 != sum2)
+  {
+    return sum1 > sum2;
+  }
+  if (to1 != to2)
+  {
+    return to1 < to2;
+  }
+  return from1 < from2;
+}
+
+//* Summary of a segment without elements, which is the identity of combineSeg
+SEG emptySeg(void)
+{
+  SEG seg = {0};
+  return seg;
+}
+
+//* Summary of a segment with the single element `value`
+SEG leafSeg(long long value)
+{
+  SEG seg;
+  seg.len = 1;
+  seg.total = seg.prefix = seg.suffix = seg.best = value;
+  seg.prefixEnd = seg.bestTo = 1;
+  seg.suffixFrom = seg.bestFrom = 0;
+  return seg;
+}
+
+//* Merge the summaries of two adjacent segments (left comes first)
+SEG combineSeg(SEG left, SEG right)
+{
+  if (left.len == 0)
+  {
+    return right;
+  }
+  if (right.len == 0)
+  {
+    return left;
+  }
+
+  SEG seg;
+  seg.len = left.len + right.len;
+  seg.total = left.total + right.total;
+
+  // The best prefix either stays in the left half or covers the whole left half
+  seg.prefix = left.prefix;
+  seg.prefixEnd = left.prefixEnd;
+  if (left.total + right.prefix > seg.prefix)
+  {
+    seg.prefix = left.total + right.prefix;
+    seg.prefixEnd = left.len + right.prefixEnd;
+  }
+
+  // The best suffix either stays in the right half or covers the whole right half
+  seg.suffix = right.suffix;
+  seg.suffixFrom = left.len + right.suffixFrom;
+  if (left.suffix + right.total >= seg.suffix)
+  {
+    seg.suffix = left.suffix + right.total;
+    seg.suffixFrom = left.suffixFrom;
+  }
+
+  // The best subarray lies in the left half, in the right half or crosses the midpoint
+  seg.best = left.best;
+  seg.bestFrom = left.bestFrom;
+  seg.bestTo = left.bestTo;
+  long long crossing = left.suffix + right.prefix;
+  if (isBetter(crossing, left.suffixFrom, left.len + right.prefixEnd, seg.best, seg.bestFrom, seg.bestTo))
+  {
+    seg.best = crossing;
+    seg.bestFrom = left.suffixFrom;
+    seg.bestTo = left.len + right.prefixEnd;
+  }
+  if (isBetter(right.best, left.len + right.bestFrom, left.len + right.bestTo, seg.best, seg.bestFrom, seg.bestTo))
+  {
+    seg.best = right.best;
+    seg.bestFrom = left.len + right.bestFrom;
+    seg.bestTo = left.len + right.bestTo;
+  }
+  return seg;
+}
+
+//* Move every offset of a summary by `offset` elements (e.g. to make them absolute)
+void shiftSeg(SEG *seg, unsigned long long offset)
+{
+  seg->prefixEnd += offset;
+  seg->suffixFrom += offset;
+  seg->bestFrom += offset;
+  seg->bestTo += offset;
+}
+
+// Summarise a block in a single pass over its prefix sums.
+// The best subarray ending at i is P[i] - min{P[j] | -1 <= j < i} where P[-1] = 0,
+// and the best suffix is the total minus the smallest prefix sum which leaves at least one element.
+#define SCAN_SEG(name, type)                                           \
+  SEG name(const type *values, unsigned long long count)               \
+  {                                                                    \
+    SEG seg = emptySeg();                                              \
+    if (count == 0)                                                    \
+    {                                                                  \
+      return seg;                                                      \
+    }                                                                  \
+    long long sum = 0;                                                 \
+    long long minSum = 0;                                              \
+    unsigned long long minFrom = 0;                                    \
+    long long suffixMin = 0;                                           \
+    seg.prefix = seg.best = values[0];                                 \
+    seg.prefixEnd = seg.bestTo = 1;                                    \
+    for (unsigned long long i = 0; i < count; i++)                     \
+    {                                                                  \
+      sum += values[i];                                                \
+      if (sum - minSum > seg.best)                                     \
+      {                                                                \
+        seg.best = sum - minSum;                                       \
+        seg.bestFrom = minFrom;                                        \
+        seg.bestTo = i + 1;                                            \
+      }                                                                \
+      if (sum > seg.prefix)                                            \
+      {                                                                \
+        seg.prefix = sum;                                              \
+        seg.prefixEnd = i + 1;                                         \
+      }                                                                \
+      suffixMin = minSum;                                              \
+      seg.suffixFrom = minFrom;                                        \
+      if (sum < minSum)                                                \
+      {                                                                \
+        minSum = sum;                                                  \
+        minFrom = i + 1;                                               \
+      }                                                                \
+    }                                                                  \
+    seg.len = count;                                                   \
+    seg.total = sum;                                                   \
+    seg.suffix = sum - suffixMin;                                      \
+    return seg;                                                        \
+  }
+
+SCAN_SEG(scanSeg32Scalar, int32_t)
+SCAN_SEG(scanSeg64, int64_t)
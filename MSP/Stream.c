@@ -0,0 +1,145 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "MSP.h"
+
+// Size of a chunk in bytes. Large enough to amortise the system calls, small enough to stay in L2 cache.
+#define MSP_CHUNK (1 << 20)
+
+static void errorMSP(char *str)
+{
+  perror(str);
+  exit(EXIT_FAILURE);
+}
+
+static unsigned elementSize(MSPType type)
+{
+  return type == MSP_INT64 ? sizeof(int64_t) : sizeof(int32_t);
+}
+
+//* Read binary values from a file descriptor (a pipe works as well) and pass them to `fn` chunk by chunk
+void readChunks(int fd, MSPType type, MSPChunkFn fn, void *ctx)
+{
+  unsigned size = elementSize(type);
+  unsigned char *buffer = (unsigned char *)malloc(MSP_CHUNK);
+  if (buffer == NULL)
+  {
+    errorMSP("readChunks: no more memory");
+  }
+
+  // `filled` bytes are in the buffer; a partial element may remain at the end of a read
+  size_t filled = 0;
+  for (;;)
+  {
+    ssize_t got = read(fd, buffer + filled, MSP_CHUNK - filled);
+    if (got < 0)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+      errorMSP("readChunks: read failed");
+    }
+    if (got == 0)
+    {
+      break;
+    }
+    filled += (size_t)got;
+
+    size_t whole = filled - filled % size;
+    if (whole > 0)
+    {
+      fn(buffer, whole / size, type, ctx);
+    }
+    // Move the partial element to the beginning of the buffer
+    for (size_t i = whole; i < filled; i++)
+    {
+      buffer[i - whole] = buffer[i];
+    }
+    filled -= whole;
+  }
+
+  free(buffer);
+  if (filled != 0)
+  {
+    fprintf(stderr, "readChunks: ignored %zu trailing bytes\n", filled);
+  }
+}
+
+//* Map a binary file into memory and pass its values to `fn` chunk by chunk without copying them
+void mapChunks(const char *path, MSPType type, MSPChunkFn fn, void *ctx)
+{
+  unsigned size = elementSize(type);
+  int fd = open(path, O_RDONLY);
+  if (fd < 0)
+  {
+    errorMSP("mapChunks: cannot open the file");
+  }
+  struct stat st;
+  if (fstat(fd, &st) < 0)
+  {
+    errorMSP("mapChunks: cannot stat the file");
+  }
+  size_t length = (size_t)st.st_size;
+  if (length == 0)
+  {
+    close(fd);
+    return;
+  }
+
+  unsigned char *base = (unsigned char *)mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (base == MAP_FAILED)
+  {
+    errorMSP("mapChunks: mmap failed");
+  }
+  close(fd);
+  // The file is read only once from front to back, so let the kernel read ahead aggressively
+  madvise(base, length, MADV_SEQUENTIAL);
+
+  size_t whole = length - length % size;
+  for (size_t offset = 0; offset < whole; offset += MSP_CHUNK)
+  {
+    size_t bytes = whole - offset < MSP_CHUNK ? whole - offset : MSP_CHUNK;
+    fn(base + offset, bytes / size, type, ctx);
+  }
+
+  munmap(base, length);
+  if (whole != length)
+  {
+    fprintf(stderr, "mapChunks: ignored %zu trailing bytes\n", length - whole);
+  }
+}
+
+// Fold a chunk into the summary of everything seen so far
+static void accumulateSeg(const void *values, unsigned long long count, MSPType type, void *ctx)
+{
+  SEG *seg = (SEG *)ctx;
+  if (type == MSP_INT64)
+  {
+    *seg = combineSeg(*seg, scanSeg64((const int64_t *)values, count));
+  }
+  else
+  {
+    *seg = combineSeg(*seg, scanSeg32((const int32_t *)values, count));
+  }
+}
+
+//* Find the maximum subarray of the values read from a file descriptor using constant memory
+SEG maxSubarrayFd(int fd, MSPType type)
+{
+  SEG seg = emptySeg();
+  readChunks(fd, type, accumulateSeg, &seg);
+  return seg;
+}
+
+//* Find the maximum subarray of a binary file through mmap
+SEG maxSubarrayFile(const char *path, MSPType type)
+{
+  SEG seg = emptySeg();
+  mapChunks(path, type, accumulateSeg, &seg);
+  return seg;
+}
@@ -0,0 +1,113 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include "MSP.h"
+
+// A part of the series [from, to) which has not been taken yet, with its best subarray
+typedef struct
+{
+  unsigned long long from;
+  unsigned long long to;
+  SEG seg;
+} CANDIDATE;
+
+static int isBetterCandidate(CANDIDATE *a, CANDIDATE *b)
+{
+  return isBetter(a->seg.best, a->seg.bestFrom, a->seg.bestTo, b->seg.best, b->seg.bestFrom, b->seg.bestTo);
+}
+
+static void swapCandidate(CANDIDATE *heap, unsigned long long i, unsigned long long j)
+{
+  CANDIDATE temp = heap[i];
+  heap[i] = heap[j];
+  heap[j] = temp;
+}
+
+// Move the node at pos up until its parent is better (max-heap on the best subarray)
+static void siftUp(CANDIDATE *heap, unsigned long long pos)
+{
+  while (pos > 0 && isBetterCandidate(&heap[pos], &heap[(pos - 1) / 2]))
+  {
+    swapCandidate(heap, pos, (pos - 1) / 2);
+    pos = (pos - 1) / 2;
+  }
+}
+
+// Move the node at pos down until both children are worse
+static void siftDown(CANDIDATE *heap, unsigned long long num, unsigned long long pos)
+{
+  for (;;)
+  {
+    unsigned long long top = pos;
+    if (2 * pos + 1 < num && isBetterCandidate(&heap[2 * pos + 1], &heap[top]))
+    {
+      top = 2 * pos + 1;
+    }
+    if (2 * pos + 2 < num && isBetterCandidate(&heap[2 * pos + 2], &heap[top]))
+    {
+      top = 2 * pos + 2;
+    }
+    if (top == pos)
+    {
+      return;
+    }
+    swapCandidate(heap, pos, top);
+    pos = top;
+  }
+}
+
+static void pushCandidate(SEGTREE *tree, CANDIDATE *heap, unsigned long long *num, unsigned long long from, unsigned long long to)
+{
+  if (from >= to)
+  {
+    return;
+  }
+  heap[*num].from = from;
+  heap[*num].to = to;
+  heap[*num].seg = querySegTree(tree, from, to);
+  siftUp(heap, (*num)++);
+}
+
+//* Take up to k disjoint subarrays greedily: the maximum subarray, then the maximum subarray of what is left, ...
+// Every part of the series left over by the segments taken so far sits in a heap keyed by its best subarray,
+// which the segment tree finds in O(log n). Taking a segment splits its part in two, so the whole run is
+// O(k log n) on top of building the tree. Returns the number of segments written to result (in taken order),
+// which needs room for the smaller of k and tree->num of them.
+unsigned long long topSubarrays(SEGTREE *tree, unsigned long long k, RANGE *result)
+{
+  // The segments are disjoint and not empty, so there are never more than tree->num of them
+  if (k > tree->num)
+  {
+    k = tree->num;
+  }
+  // Every step removes one candidate and adds at most two
+  CANDIDATE *heap = (CANDIDATE *)malloc(sizeof(CANDIDATE) * (k + 1));
+  if (heap == NULL)
+  {
+    perror("topSubarrays: no more memory");
+    exit(EXIT_FAILURE);
+  }
+  unsigned long long num = 0;
+  pushCandidate(tree, heap, &num, 0, tree->num);
+
+  unsigned long long found = 0;
+  while (found < k && num > 0)
+  {
+    CANDIDATE top = heap[0];
+    heap[0] = heap[--num];
+    siftDown(heap, num, 0);
+
+    result[found].sum = top.seg.best;
+    result[found].from = top.seg.bestFrom;
+    result[found].to = top.seg.bestTo;
+    found++;
+
+    // The heap holds at most k + 1 candidates as long as we stop pushing once k segments are taken
+    if (found < k)
+    {
+      pushCandidate(tree, heap, &num, top.from, top.seg.bestFrom);
+      pushCandidate(tree, heap, &num, top.seg.bestTo, top.to);
+    }
+  }
+  free(heap);
+  return found;
+}
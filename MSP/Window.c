@@ -0,0 +1,95 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include "MSP.h"
+
+static void errorWindow(char *str)
+{
+  fprintf(stderr, "%s\n", str);
+  exit(EXIT_FAILURE);
+}
+
+WINDOW *newWindow(unsigned long long capacity)
+{
+  WINDOW *win;
+  if (capacity == 0)
+  {
+    errorWindow("newWindow: capacity must be positive");
+  }
+  if ((win = (WINDOW *)malloc(sizeof(WINDOW))) == NULL)
+  {
+    errorWindow("newWindow: no more memory");
+  }
+  win->capacity = capacity;
+  win->pushed = 0;
+  win->front = (SEG *)malloc(sizeof(SEG) * capacity);
+  win->frontNum = 0;
+  win->back = (long long *)malloc(sizeof(long long) * capacity);
+  win->backNum = 0;
+  win->backSeg = emptySeg();
+  if (win->front == NULL || win->back == NULL)
+  {
+    errorWindow("newWindow: too large");
+  }
+  return win;
+}
+
+void freeWindow(WINDOW *win)
+{
+  free(win->front);
+  free(win->back);
+  free(win);
+}
+
+//* Number of samples in the window
+unsigned long long sizeWindow(WINDOW *win)
+{
+  return win->frontNum + win->backNum;
+}
+
+//* Drop the oldest sample
+void evictWindow(WINDOW *win)
+{
+  if (sizeWindow(win) == 0)
+  {
+    errorWindow("evictWindow: the window is empty");
+  }
+
+  // Move the back stack over to the front stack, newest first, so that the oldest sample ends up on top.
+  // Every sample is moved once, which makes eviction amortised O(1).
+  if (win->frontNum == 0)
+  {
+    SEG seg = emptySeg();
+    for (unsigned long long i = win->backNum; i-- > 0;)
+    {
+      seg = combineSeg(leafSeg(win->back[i]), seg);
+      win->front[win->frontNum++] = seg;
+    }
+    win->backNum = 0;
+    win->backSeg = emptySeg();
+  }
+  win->frontNum--;
+}
+
+//* Append a sample, evicting the oldest one when the window is full
+void pushWindow(WINDOW *win, long long value)
+{
+  if (sizeWindow(win) == win->capacity)
+  {
+    evictWindow(win);
+  }
+  win->back[win->backNum++] = value;
+  win->backSeg = combineSeg(win->backSeg, leafSeg(value));
+  win->pushed++;
+}
+
+//* Best subarray of the window; the offsets count samples since the window was created
+SEG bestWindow(WINDOW *win)
+{
+  SEG seg = win->backSeg;
+  if (win->frontNum > 0)
+  {
+    seg = combineSeg(win->front[win->frontNum - 1], seg);
+  }
+  shiftSeg(&seg, win->pushed - sizeWindow(win));
+  return seg;
+}
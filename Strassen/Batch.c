@@ -0,0 +1,297 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "Matrix.h"
+#include "Batch.h"
+#include "Pool.h"
+
+static void errorBatch(char *str)
+{
+  perror(str);
+  exit(EXIT_FAILURE);
+}
+
+static unsigned long blocksOf(BATCH *batch)
+{
+  return ((unsigned long)batch->count + BATCH_BLOCK - 1) / BATCH_BLOCK;
+}
+
+// Index of element (x, y) of matrix b
+static unsigned long indexBatch(BATCH *batch, unsigned b, unsigned x, unsigned y)
+{
+  unsigned long block = b / BATCH_BLOCK;
+  return (block * batch->x * batch->y + (unsigned long)x * batch->y + y) * BATCH_BLOCK + b % BATCH_BLOCK;
+}
+
+//* Allocate a batch of `count` sizeX x sizeY matrices of zeros
+BATCH *newBatch(unsigned sizeX, unsigned sizeY, unsigned count)
+{
+  BATCH *new;
+  if ((new = (BATCH *)malloc(sizeof(BATCH))) == NULL)
+  {
+    errorBatch("newBatch: no more memory");
+  }
+  new->x = sizeX;
+  new->y = sizeY;
+  new->count = count;
+  unsigned long size = blocksOf(new) * sizeX * sizeY * BATCH_BLOCK;
+  if ((new->v = (int *)calloc(size > 0 ? size : 1, sizeof(int))) == NULL)
+  {
+    errorBatch("newBatch: too large");
+  }
+  return new;
+}
+
+void freeBatch(BATCH *batch)
+{
+  free(batch->v);
+  free(batch);
+}
+
+int getBatch(BATCH *batch, unsigned b, unsigned x, unsigned y)
+{
+#if MAT_CHECKED
+  if (b >= batch->count || x >= batch->x || y >= batch->y)
+    rangeErrorMat("getBatch: out of range");
+#endif
+  return batch->v[indexBatch(batch, b, x, y)];
+}
+
+void setBatch(BATCH *batch, unsigned b, unsigned x, unsigned y, int val)
+{
+#if MAT_CHECKED
+  if (b >= batch->count || x >= batch->x || y >= batch->y)
+    rangeErrorMat("setBatch: out of range");
+#endif
+  batch->v[indexBatch(batch, b, x, y)] = val;
+}
+
+//* Store a matrix of the shape of the batch as its matrix b
+void packBatch(BATCH *batch, unsigned b, MAT *mat)
+{
+  if (b >= batch->count || mat->x != batch->x || mat->y != batch->y)
+  {
+    rangeErrorMat("packBatch: the matrix does not fit the batch");
+  }
+  int *dst = batch->v + indexBatch(batch, b, 0, 0);
+  for (unsigned i = 0; i < mat->x; i++)
+  {
+    const int *row = rowMat(mat, i);
+    for (unsigned j = 0; j < mat->y; j++)
+    {
+      dst[((unsigned long)i * mat->y + j) * BATCH_BLOCK] = row[j];
+    }
+  }
+}
+
+//* Copy matrix b of the batch into a matrix of the same shape
+void unpackBatch(BATCH *batch, unsigned b, MAT *mat)
+{
+  if (b >= batch->count || mat->x != batch->x || mat->y != batch->y)
+  {
+    rangeErrorMat("unpackBatch: the matrix does not fit the batch");
+  }
+  const int *src = batch->v + indexBatch(batch, b, 0, 0);
+  for (unsigned i = 0; i < mat->x; i++)
+  {
+    int *row = rowMat(mat, i);
+    for (unsigned j = 0; j < mat->y; j++)
+    {
+      row[j] = src[((unsigned long)i * mat->y + j) * BATCH_BLOCK];
+    }
+  }
+}
+
+// Kernels multiplying the BATCH_BLOCK pairs of m x p and p x n matrices of one block.
+// Every element of C is accumulated in one vector of BATCH_BLOCK lanes, and the lanes never mix.
+typedef void (*BLOCKFN)(const int *a, const int *b, int *c, unsigned m, unsigned p, unsigned n);
+
+#define BLOCK_KERNEL(suffix, attr)                                                                                \
+  attr static void multiplyBlock##suffix(const int *restrict a, const int *restrict b, int *restrict c, unsigned m, \
+                                         unsigned p, unsigned n)                                                   \
+  {                                                                                                                \
+    for (unsigned i = 0; i < m; i++)                                                                               \
+    {                                                                                                              \
+      for (unsigned j = 0; j < n; j++)                                                                             \
+      {                                                                                                            \
+        int acc[BATCH_BLOCK] = {0};                                                                                \
+        for (unsigned k = 0; k < p; k++)                                                                           \
+        {                                                                                                          \
+          const int *ak = a + ((unsigned long)i * p + k) * BATCH_BLOCK;                                            \
+          const int *bk = b + ((unsigned long)k * n + j) * BATCH_BLOCK;                                            \
+          for (unsigned w = 0; w < BATCH_BLOCK; w++)                                                               \
+          {                                                                                                        \
+            acc[w] += ak[w] * bk[w];                                                                               \
+          }                                                                                                        \
+        }                                                                                                          \
+        int *cij = c + ((unsigned long)i * n + j) * BATCH_BLOCK;                                                   \
+        for (unsigned w = 0; w < BATCH_BLOCK; w++)                                                                 \
+        {                                                                                                          \
+          cij[w] = acc[w];                                                                                         \
+        }                                                                                                          \
+      }                                                                                                            \
+    }                                                                                                              \
+  }
+
+// The same kernel for N x N matrices, with the size known at compile time so that the loop over k is fully unrolled
+#define SIZED_KERNEL(N, suffix, attr)                                                                             \
+  attr static void multiplyBlock##N##suffix(const int *restrict a, const int *restrict b, int *restrict c,        \
+                                            unsigned m, unsigned p, unsigned n)                                   \
+  {                                                                                                                \
+    (void)m, (void)p, (void)n;                                                                                     \
+    for (unsigned i = 0; i < N; i++)                                                                               \
+    {                                                                                                              \
+      for (unsigned j = 0; j < N; j++)                                                                             \
+      {                                                                                                            \
+        int acc[BATCH_BLOCK] = {0};                                                                                \
+        _Pragma("GCC unroll 32") for (unsigned k = 0; k < N; k++)                                                  \
+        {                                                                                                          \
+          const int *ak = a + (i * N + k) * BATCH_BLOCK;                                                           \
+          const int *bk = b + (k * N + j) * BATCH_BLOCK;                                                           \
+          for (unsigned w = 0; w < BATCH_BLOCK; w++)                                                               \
+          {                                                                                                        \
+            acc[w] += ak[w] * bk[w];                                                                               \
+          }                                                                                                        \
+        }                                                                                                          \
+        for (unsigned w = 0; w < BATCH_BLOCK; w++)                                                                 \
+        {                                                                                                          \
+          c[(i * N + j) * BATCH_BLOCK + w] = acc[w];                                                               \
+        }                                                                                                          \
+      }                                                                                                            \
+    }                                                                                                              \
+  }
+
+// The generic kernel and those for 4 x 4, 8 x 8, 16 x 16 and 32 x 32, in the order of sizeIndex()
+#define BATCH_KERNELS(suffix, attr)                                                                      \
+  BLOCK_KERNEL(suffix, attr)                                                                             \
+  SIZED_KERNEL(4, suffix, attr)                                                                          \
+  SIZED_KERNEL(8, suffix, attr)                                                                          \
+  SIZED_KERNEL(16, suffix, attr)                                                                         \
+  SIZED_KERNEL(32, suffix, attr)                                                                         \
+  static const BLOCKFN kernels##suffix[] = {multiplyBlock##suffix, multiplyBlock4##suffix, multiplyBlock8##suffix, \
+                                            multiplyBlock16##suffix, multiplyBlock32##suffix};
+
+// The lane-wise multiplication needs SSE4.1 or AVX2 to be vectorised, so x86 gets an AVX2 build picked at run time
+BATCH_KERNELS(Base, )
+#if defined(__x86_64__) || defined(__i386__)
+#define BATCH_HAVE_X86 1
+BATCH_KERNELS(Avx2, __attribute__((target("avx2"))))
+#endif
+
+// The table for the instruction set of this CPU, chosen once by the first multiplyBatch()
+static const BLOCKFN *batchKernels;
+static pthread_once_t batchKernelsOnce = PTHREAD_ONCE_INIT;
+
+static void selectBatchKernels(void)
+{
+#ifdef BATCH_HAVE_X86
+  __builtin_cpu_init();
+  batchKernels = __builtin_cpu_supports("avx2") ? kernelsAvx2 : kernelsBase;
+#else
+  batchKernels = kernelsBase;
+#endif
+}
+
+static const BLOCKFN *getBatchKernels(void)
+{
+  pthread_once(&batchKernelsOnce, selectBatchKernels);
+  return batchKernels;
+}
+
+// Index of the kernel for m x p by p x n matrices in the tables of BATCH_KERNELS
+static unsigned sizeIndex(unsigned m, unsigned p, unsigned n)
+{
+  if (m != p || p != n)
+  {
+    return 0;
+  }
+  switch (m)
+  {
+  case 4:
+    return 1;
+  case 8:
+    return 2;
+  case 16:
+    return 3;
+  case 32:
+    return 4;
+  default:
+    return 0;
+  }
+}
+
+// A range of blocks multiplied by one task
+typedef struct
+{
+  BATCH *matA, *matB, *matC;
+  BLOCKFN kernel;
+  unsigned long first, last;
+} BATCHTASK;
+
+static void multiplyBlocks(BATCHTASK *task)
+{
+  unsigned m = task->matA->x, p = task->matA->y, n = task->matB->y;
+  unsigned long sizeA = (unsigned long)m * p * BATCH_BLOCK;
+  unsigned long sizeB = (unsigned long)p * n * BATCH_BLOCK;
+  unsigned long sizeC = (unsigned long)m * n * BATCH_BLOCK;
+  for (unsigned long block = task->first; block < task->last; block++)
+  {
+    task->kernel(task->matA->v + block * sizeA, task->matB->v + block * sizeB, task->matC->v + block * sizeC, m, p, n);
+  }
+}
+
+static void batchTask(void *arg, unsigned worker)
+{
+  (void)worker;
+  multiplyBlocks((BATCHTASK *)arg);
+}
+
+//* Calculate the products of the matrices of two batches (C[b] = A[b] * B[b] for every b) on `threads` threads
+// (0 means one per online core). Square matrices of 4, 8, 16 and 32 go through kernels specialised for their size.
+void multiplyBatch(BATCH *matA, BATCH *matB, BATCH *matC, unsigned threads)
+{
+  if (matA->y != matB->x || matC->x != matA->x || matC->y != matB->y ||
+      matB->count != matA->count || matC->count != matA->count)
+  {
+    fprintf(stderr, "multiplyBatch: the shapes of the batches do not match\n");
+    exit(EXIT_FAILURE);
+  }
+
+  BATCHTASK whole = {matA, matB, matC, NULL, 0, blocksOf(matA)};
+  whole.kernel = getBatchKernels()[sizeIndex(matA->x, matA->y, matB->y)];
+
+  if (threads == 0)
+  {
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    threads = online > 0 ? (unsigned)online : 1;
+  }
+  unsigned long tasks = (unsigned long)BATCH_TASKS_PER_THREAD * threads;
+  if (tasks > whole.last)
+  {
+    tasks = whole.last;
+  }
+  if (threads <= 1 || tasks <= 1)
+  {
+    multiplyBlocks(&whole);
+    return;
+  }
+
+  BATCHTASK *ranges;
+  if ((ranges = (BATCHTASK *)malloc(tasks * sizeof(BATCHTASK))) == NULL)
+  {
+    errorBatch("multiplyBatch: no more memory");
+  }
+  POOL *pool = newPool(threads);
+  TASKGROUP group = {0};
+  for (unsigned long t = 0; t < tasks; t++)
+  {
+    ranges[t] = whole;
+    ranges[t].first = whole.last * t / tasks;
+    ranges[t].last = whole.last * (t + 1) / tasks;
+    spawnTask(pool, 0, batchTask, &ranges[t], &group);
+  }
+  waitTasks(pool, 0, &group);
+  freePool(pool);
+  free(ranges);
+}
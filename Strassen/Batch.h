@@ -0,0 +1,23 @@
+// Number of matrices whose elements are interleaved; a kernel works on that many matrices at once, one per vector lane
+#define BATCH_BLOCK 16
+// multiplyBatch() splits a batch into about this many tasks per thread
+#define BATCH_TASKS_PER_THREAD 4
+
+// Batch of `count` small matrices of the same shape, interleaved by blocks of BATCH_BLOCK matrices:
+// within a block, the elements (i, j) of its matrices are next to each other, and every block is contiguous.
+// Matrix b is in block b / BATCH_BLOCK, at lane b % BATCH_BLOCK; the lanes after the last matrix hold zeros.
+typedef struct
+{
+  unsigned x;     // 行数 rows of every matrix
+  unsigned y;     // 列数 columns of every matrix
+  unsigned count; // 行列の数 number of matrices
+  int *v;         // 先頭のブロック first block
+} BATCH;
+
+BATCH *newBatch(unsigned sizeX, unsigned sizeY, unsigned count);
+void freeBatch(BATCH *batch);
+int getBatch(BATCH *batch, unsigned b, unsigned x, unsigned y);
+void setBatch(BATCH *batch, unsigned b, unsigned x, unsigned y, int val);
+void packBatch(BATCH *batch, unsigned b, MAT *mat);
+void unpackBatch(BATCH *batch, unsigned b, MAT *mat);
+void multiplyBatch(BATCH *matA, BATCH *matB, BATCH *matC, unsigned threads);
@@ -0,0 +1,163 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include "Matrix.h"
+#include "Strassen.h"
+#include "Chain.h"
+
+static void errorChain(char *str)
+{
+  perror(str);
+  exit(EXIT_FAILURE);
+}
+
+//* Cost of an m x p by p x n product as Strassen() computes it, in element operations:
+// m p n multiply-adds below the crossover, and above it seven half-sized products, the 18 additions of the level
+// and the peeling of the odd row and columns.
+double strassenCost(unsigned m, unsigned p, unsigned n)
+{
+  if (isStrassenLeaf(m, p, n))
+  {
+    return (double)m * p * n;
+  }
+  unsigned halfM = m / 2, halfP = p / 2, halfN = n / 2;
+  double additions = 5.0 * halfM * halfP + 5.0 * halfP * halfN + 8.0 * halfM * halfN;
+  double peeled = (double)m * p * n - 8.0 * halfM * halfP * halfN;
+  return 7 * strassenCost(halfM, halfP, halfN) + additions + peeled;
+}
+
+// Optimal order of a chain: mats[i..j] is split into mats[i..s] and mats[s+1..j] with s = split[i * count + j]
+typedef struct
+{
+  MAT **mats;
+  unsigned count;
+  unsigned *split;
+} CHAIN;
+
+static unsigned rowsOf(CHAIN *chain, unsigned i)
+{
+  return chain->mats[i]->x;
+}
+
+static unsigned colsOf(CHAIN *chain, unsigned j)
+{
+  return chain->mats[j]->y;
+}
+
+// Elements of workspace needed to compute mats[i..j] into a given matrix: the products of both halves
+// which are not single matrices, plus the larger of what the halves need and what their product needs
+static unsigned long chainWorkspace(CHAIN *chain, unsigned i, unsigned j)
+{
+  if (i == j)
+  {
+    return 0;
+  }
+  unsigned s = chain->split[i * chain->count + j];
+  unsigned long sizeL = s > i ? (unsigned long)rowsOf(chain, i) * colsOf(chain, s) : 0;
+  unsigned long sizeR = j > s + 1 ? (unsigned long)rowsOf(chain, s + 1) * colsOf(chain, j) : 0;
+  unsigned long need = sizeL + chainWorkspace(chain, i, s);
+  unsigned long needR = sizeL + sizeR + chainWorkspace(chain, s + 1, j);
+  unsigned long needProduct = sizeL + sizeR + strassenWorkspace(rowsOf(chain, i), colsOf(chain, s), colsOf(chain, j));
+  need = need > needR ? need : needR;
+  return need > needProduct ? need : needProduct;
+}
+
+// Compute mats[i..j] into `dst`, taking the intermediate products and the workspace of Strassen's algorithm from `arena`
+static void multiplyRange(CHAIN *chain, unsigned i, unsigned j, MAT *dst, ARENA *arena)
+{
+  unsigned s = chain->split[i * chain->count + j];
+  unsigned long mark = arena->used;
+  MAT matL, matR;
+  MAT *left = chain->mats[i], *right = chain->mats[j];
+  if (s > i)
+  {
+    matL = allocArena(arena, rowsOf(chain, i), colsOf(chain, s));
+    multiplyRange(chain, i, s, &matL, arena);
+    left = &matL;
+  }
+  if (j > s + 1)
+  {
+    matR = allocArena(arena, rowsOf(chain, s + 1), colsOf(chain, j));
+    multiplyRange(chain, s + 1, j, &matR, arena);
+    right = &matR;
+  }
+  if (isStrassenLeaf(left->x, left->y, right->y))
+  {
+    multiplyClassic(left, right, dst);
+  }
+  else
+  {
+    strassenRecursive(left, right, dst, arena);
+  }
+  arena->used = mark;
+}
+
+//* Calculate the product of a chain of matrices (result = mats[0] * mats[1] * ... * mats[count - 1]).
+// The order of the products is the one of least strassenCost(), found by dynamic programming over all parenthesizations,
+// and every intermediate product and temporary matrix is taken from a single workspace.
+void multiplyChain(MAT *mats[], unsigned count, MAT *result)
+{
+  if (count == 0)
+  {
+    printf("Error: The chain must have at least one matrix.\n");
+    exit(1);
+  }
+  for (unsigned i = 0; i + 1 < count; i++)
+  {
+    if (mats[i]->y != mats[i + 1]->x)
+    {
+      printf("Error: The number of columns of each matrix must be equal to the number of rows of the next one.\n");
+      exit(1);
+    }
+  }
+  if (result->x != mats[0]->x || result->y != mats[count - 1]->y)
+  {
+    printf("Error: The result must have as many rows as the first matrix and as many columns as the last one.\n");
+    exit(1);
+  }
+  if (count == 1)
+  {
+    for (unsigned i = 0; i < result->x; i++)
+    {
+      const int *src = rowMat(mats[0], i);
+      int *dst = rowMat(result, i);
+      for (unsigned j = 0; j < result->y; j++)
+      {
+        dst[j] = src[j];
+      }
+    }
+    return;
+  }
+
+  CHAIN chain = {mats, count, NULL};
+  double *cost;
+  if ((cost = (double *)calloc((unsigned long)count * count, sizeof(double))) == NULL ||
+      (chain.split = (unsigned *)calloc((unsigned long)count * count, sizeof(unsigned))) == NULL)
+  {
+    errorChain("multiplyChain: no more memory");
+  }
+  // cost[i * count + j]: least cost of mats[i..j], over chains of increasing length
+  for (unsigned length = 2; length <= count; length++)
+  {
+    for (unsigned i = 0; i + length <= count; i++)
+    {
+      unsigned j = i + length - 1;
+      double best = -1;
+      for (unsigned s = i; s < j; s++)
+      {
+        double c = cost[i * count + s] + cost[(s + 1) * count + j] + strassenCost(rowsOf(&chain, i), colsOf(&chain, s), colsOf(&chain, j));
+        if (best < 0 || c < best)
+        {
+          best = c;
+          chain.split[i * count + j] = s;
+        }
+      }
+      cost[i * count + j] = best;
+    }
+  }
+  free(cost);
+
+  ARENA *arena = newArena(chainWorkspace(&chain, 0, count - 1));
+  multiplyRange(&chain, 0, count - 1, result, arena);
+  freeArena(arena);
+  free(chain.split);
+}
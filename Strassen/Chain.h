@@ -0,0 +1,2 @@
+double strassenCost(unsigned m, unsigned p, unsigned n);
+void multiplyChain(MAT *mats[], unsigned count, MAT *result);
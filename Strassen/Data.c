@@ -25,7 +25,7 @@ int data1_[] = {
 	2,	5,	5,	20,	5,	11,	10,	16,	21,	16,
 	5,	14,	4,	19,	19,	11,	10,	5,	1,	7
 };
-MAT data1 = { 22, 10, data1_ };
+MAT data1 = { 22, 10, data1_, 10 };
 
 int data2_[] = {
 	7,	1,	8,	18,	5,	19,	5,	8,
@@ -39,4 +39,4 @@ int data2_[] = {
 	12,	16,	19,	15,	13,	16,	4,	19,
 	6,	21,	13,	18,	16,	10,	20,	17
 };
-MAT data2 = { 10, 8, data2_ };
+MAT data2 = { 10, 8, data2_, 8 };
@@ -0,0 +1,202 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <pthread.h>
+#include "Matrix.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define STRASSEN_HAVE_X86 1
+#endif
+
+// Element-wise kernels used to form the operands and combine the products of Strassen's algorithm.
+// Each one makes a single pass over the rows of its operands, and over the whole matrix at once when every operand is contiguous.
+// The destination may be one of the sources, but must not partially overlap them.
+
+// Row kernels: the vector loop handles WIDTH elements at a time and the scalar loop handles the rest
+#define ROW_KERNELS(suffix, attr, WIDTH, LOAD, STORE, ADD, SUB, ZERO)                                      \
+  attr static void negateRow##suffix(const int *a, int *c, unsigned long n)                                \
+  {                                                                                                        \
+    unsigned long j = 0;                                                                                   \
+    for (; j + WIDTH <= n; j += WIDTH)                                                                     \
+    {                                                                                                      \
+      STORE(c + j, SUB(ZERO, LOAD(a + j)));                                                                \
+    }                                                                                                      \
+    for (; j < n; j++)                                                                                     \
+    {                                                                                                      \
+      c[j] = -a[j];                                                                                        \
+    }                                                                                                      \
+  }                                                                                                        \
+  attr static void addRow##suffix(const int *a, const int *b, int *c, unsigned long n)                     \
+  {                                                                                                        \
+    unsigned long j = 0;                                                                                   \
+    for (; j + WIDTH <= n; j += WIDTH)                                                                     \
+    {                                                                                                      \
+      STORE(c + j, ADD(LOAD(a + j), LOAD(b + j)));                                                         \
+    }                                                                                                      \
+    for (; j < n; j++)                                                                                     \
+    {                                                                                                      \
+      c[j] = a[j] + b[j];                                                                                  \
+    }                                                                                                      \
+  }                                                                                                        \
+  attr static void subRow##suffix(const int *a, const int *b, int *c, unsigned long n)                     \
+  {                                                                                                        \
+    unsigned long j = 0;                                                                                   \
+    for (; j + WIDTH <= n; j += WIDTH)                                                                     \
+    {                                                                                                      \
+      STORE(c + j, SUB(LOAD(a + j), LOAD(b + j)));                                                         \
+    }                                                                                                      \
+    for (; j < n; j++)                                                                                     \
+    {                                                                                                      \
+      c[j] = a[j] - b[j];                                                                                  \
+    }                                                                                                      \
+  }                                                                                                        \
+  attr static void combineRow##suffix(const int *a, const int *b, const int *c, const int *d, int *e, unsigned long n) \
+  {                                                                                                        \
+    unsigned long j = 0;                                                                                   \
+    for (; j + WIDTH <= n; j += WIDTH)                                                                     \
+    {                                                                                                      \
+      STORE(e + j, ADD(SUB(ADD(LOAD(a + j), LOAD(b + j)), LOAD(c + j)), LOAD(d + j)));                     \
+    }                                                                                                      \
+    for (; j < n; j++)                                                                                     \
+    {                                                                                                      \
+      e[j] = a[j] + b[j] - c[j] + d[j];                                                                    \
+    }                                                                                                      \
+  }
+
+#ifdef STRASSEN_HAVE_X86
+
+// SSE2 is part of x86-64, so it is the baseline
+#define LOAD_128(p) _mm_loadu_si128((const __m128i *)(p))
+#define STORE_128(p, x) _mm_storeu_si128((__m128i *)(p), (x))
+ROW_KERNELS(Sse2, __attribute__((target("sse2"))), 4, LOAD_128, STORE_128, _mm_add_epi32, _mm_sub_epi32, _mm_setzero_si128())
+
+#define LOAD_256(p) _mm256_loadu_si256((const __m256i *)(p))
+#define STORE_256(p, x) _mm256_storeu_si256((__m256i *)(p), (x))
+ROW_KERNELS(Avx2, __attribute__((target("avx2"))), 8, LOAD_256, STORE_256, _mm256_add_epi32, _mm256_sub_epi32, _mm256_setzero_si256())
+
+#else
+
+// Without a vector unit every element goes through the scalar loop
+#define LOAD_SCALAR(p) (*(p))
+#define STORE_SCALAR(p, x) (*(p) = (x))
+#define ADD_SCALAR(x, y) ((x) + (y))
+#define SUB_SCALAR(x, y) ((x) - (y))
+ROW_KERNELS(Scalar, , 1, LOAD_SCALAR, STORE_SCALAR, ADD_SCALAR, SUB_SCALAR, 0)
+
+#endif
+
+// Row kernels of the widest instruction set the CPU supports, chosen once for all threads
+typedef struct
+{
+  void (*negate)(const int *a, int *c, unsigned long n);
+  void (*add)(const int *a, const int *b, int *c, unsigned long n);
+  void (*sub)(const int *a, const int *b, int *c, unsigned long n);
+  void (*combine)(const int *a, const int *b, const int *c, const int *d, int *e, unsigned long n);
+} ROWKERNELS;
+
+#define ROW_KERNELS_OF(suffix) \
+  ((ROWKERNELS){negateRow##suffix, addRow##suffix, subRow##suffix, combineRow##suffix})
+
+static ROWKERNELS rowKernels;
+static pthread_once_t rowKernelsOnce = PTHREAD_ONCE_INIT;
+
+static void selectRowKernels(void)
+{
+#ifdef STRASSEN_HAVE_X86
+  __builtin_cpu_init();
+  rowKernels = __builtin_cpu_supports("avx2") ? ROW_KERNELS_OF(Avx2) : ROW_KERNELS_OF(Sse2);
+#else
+  rowKernels = ROW_KERNELS_OF(Scalar);
+#endif
+}
+
+static const ROWKERNELS *getRowKernels(void)
+{
+  pthread_once(&rowKernelsOnce, selectRowKernels);
+  return &rowKernels;
+}
+
+// The operands must have the same shape as the destination
+static void checkShape(MAT *mat, MAT *dst)
+{
+  if (mat->x != dst->x || mat->y != dst->y)
+  {
+    printf("Error: The matrices must have the same number of rows and columns.\n");
+    exit(1);
+  }
+}
+
+// Whether the rows of the matrix follow each other without a gap, so that it can be processed as a single row
+static int isContiguous(MAT *mat)
+{
+  return mat->stride == mat->y || mat->x <= 1;
+}
+
+//* Negate all elements of a matrix
+void negateMatrix(MAT *src, MAT *dst)
+{
+  checkShape(src, dst);
+  void (*row)(const int *, int *, unsigned long) = getRowKernels()->negate;
+  if (isContiguous(src) && isContiguous(dst))
+  {
+    row(src->v, dst->v, (unsigned long)dst->x * dst->y);
+    return;
+  }
+  for (unsigned i = 0; i < dst->x; i++)
+  {
+    row(rowMat(src, i), rowMat(dst, i), dst->y);
+  }
+}
+
+//* Add two matrices (C = A + B)
+void addMatrix(MAT *matA, MAT *matB, MAT *matC)
+{
+  checkShape(matA, matC);
+  checkShape(matB, matC);
+  void (*row)(const int *, const int *, int *, unsigned long) = getRowKernels()->add;
+  if (isContiguous(matA) && isContiguous(matB) && isContiguous(matC))
+  {
+    row(matA->v, matB->v, matC->v, (unsigned long)matC->x * matC->y);
+    return;
+  }
+  for (unsigned i = 0; i < matC->x; i++)
+  {
+    row(rowMat(matA, i), rowMat(matB, i), rowMat(matC, i), matC->y);
+  }
+}
+
+//* Subtract two matrices (C = A - B)
+void subMatrix(MAT *matA, MAT *matB, MAT *matC)
+{
+  checkShape(matA, matC);
+  checkShape(matB, matC);
+  void (*row)(const int *, const int *, int *, unsigned long) = getRowKernels()->sub;
+  if (isContiguous(matA) && isContiguous(matB) && isContiguous(matC))
+  {
+    row(matA->v, matB->v, matC->v, (unsigned long)matC->x * matC->y);
+    return;
+  }
+  for (unsigned i = 0; i < matC->x; i++)
+  {
+    row(rowMat(matA, i), rowMat(matB, i), rowMat(matC, i), matC->y);
+  }
+}
+
+//* Combine four matrices (E = A + B - C + D), the shape of C11 and C22 in Strassen's algorithm
+void combineMatrix(MAT *matA, MAT *matB, MAT *matC, MAT *matD, MAT *matE)
+{
+  checkShape(matA, matE);
+  checkShape(matB, matE);
+  checkShape(matC, matE);
+  checkShape(matD, matE);
+  void (*row)(const int *, const int *, const int *, const int *, int *, unsigned long) = getRowKernels()->combine;
+  if (isContiguous(matA) && isContiguous(matB) && isContiguous(matC) && isContiguous(matD) && isContiguous(matE))
+  {
+    row(matA->v, matB->v, matC->v, matD->v, matE->v, (unsigned long)matE->x * matE->y);
+    return;
+  }
+  for (unsigned i = 0; i < matE->x; i++)
+  {
+    row(rowMat(matA, i), rowMat(matB, i), rowMat(matC, i), rowMat(matD, i), rowMat(matE, i), matE->y);
+  }
+}
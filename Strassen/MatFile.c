@@ -0,0 +1,188 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "Matrix.h"
+#include "MatFile.h"
+
+// Header of a rows x cols matrix of int whose payload follows the first page
+static MATHEADER headerOf(unsigned rows, unsigned cols)
+{
+  MATHEADER header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, MATFILE_MAGIC, 4);
+  header.byteOrder = MATFILE_BYTE_ORDER;
+  header.version = MATFILE_VERSION;
+  header.type = MATFILE_INT32;
+  header.rows = rows;
+  header.cols = cols;
+  header.stride = cols;
+  header.alignment = MATFILE_ALIGNMENT;
+  header.offset = MATFILE_ALIGNMENT;
+  return header;
+}
+
+// Map `length` bytes of an open file and wrap the payload described by `header` as a MAT; the descriptor is closed
+static MATFILE *mapMatFile(int fd, size_t length, MATHEADER *header, int prot, int flags)
+{
+  void *base = mmap(NULL, length, prot, flags, fd, 0);
+  int error = errno;
+  close(fd);
+  if (base == MAP_FAILED)
+  {
+    errno = error;
+    return NULL;
+  }
+  MATFILE *file;
+  if ((file = (MATFILE *)malloc(sizeof(MATFILE))) == NULL)
+  {
+    munmap(base, length);
+    errno = ENOMEM;
+    return NULL;
+  }
+  file->base = base;
+  file->length = length;
+  file->mat.x = header->rows;
+  file->mat.y = header->cols;
+  file->mat.stride = header->stride;
+  file->mat.v = (int *)((char *)base + header->offset);
+  return file;
+}
+
+// Whether a header read from a file of `size` bytes describes a matrix of int of this byte order which lies inside the file.
+// The fields are untrusted, so the payload is bounded by dividing the room left after the offset instead of multiplying.
+static int validHeader(MATHEADER *header, unsigned long long size)
+{
+  if (memcmp(header->magic, MATFILE_MAGIC, 4) != 0 || header->byteOrder != MATFILE_BYTE_ORDER ||
+      header->version != MATFILE_VERSION || header->type != MATFILE_INT32 || header->stride < header->cols)
+  {
+    return 0;
+  }
+  // The alignment is a power of two which the offset honours, and the payload starts after the header and inside the file
+  if (header->alignment == 0 || (header->alignment & (header->alignment - 1)) != 0 ||
+      header->offset % header->alignment != 0 || header->offset % sizeof(int) != 0 ||
+      header->offset < sizeof(*header) || header->offset > size)
+  {
+    return 0;
+  }
+  // rows * stride elements fit in the size - offset bytes after it
+  unsigned long long room = (size - header->offset) / sizeof(int);
+  return header->stride == 0 || header->rows <= room / header->stride;
+}
+
+//* Map a matrix file into memory without parsing it.
+// The mapping is private: changes to the matrix are not written back. Returns NULL with errno set on failure
+// (EINVAL if the file is not a matrix of int written on a machine of the same byte order).
+MATFILE *openMatFile(const char *path)
+{
+  int fd = open(path, O_RDONLY);
+  if (fd < 0)
+  {
+    return NULL;
+  }
+  struct stat st;
+  MATHEADER header;
+  if (fstat(fd, &st) != 0 || pread(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header))
+  {
+    int error = errno;
+    close(fd);
+    errno = error != 0 ? error : EINVAL;
+    return NULL;
+  }
+  if (!validHeader(&header, (unsigned long long)st.st_size))
+  {
+    close(fd);
+    errno = EINVAL;
+    return NULL;
+  }
+  return mapMatFile(fd, (size_t)st.st_size, &header, PROT_READ | PROT_WRITE, MAP_PRIVATE);
+}
+
+//* Create a rows x cols matrix file of zeros and map it into memory.
+// The mapping is shared, so whatever is stored in the matrix ends up in the file: a product can be written straight to disk.
+MATFILE *createMatFile(const char *path, unsigned rows, unsigned cols)
+{
+  MATHEADER header = headerOf(rows, cols);
+  size_t length = header.offset + (size_t)rows * cols * sizeof(int);
+  int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+  {
+    return NULL;
+  }
+  if (ftruncate(fd, (off_t)length) != 0 || pwrite(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header))
+  {
+    int error = errno;
+    close(fd);
+    errno = error;
+    return NULL;
+  }
+  return mapMatFile(fd, length, &header, PROT_READ | PROT_WRITE, MAP_SHARED);
+}
+
+//* Unmap a matrix file; for a file from createMatFile() this is when the matrix is complete on disk
+void closeMatFile(MATFILE *file)
+{
+  munmap(file->base, file->length);
+  free(file);
+}
+
+// Write all `length` bytes, retrying short writes
+static int writeAll(int fd, const void *buffer, size_t length)
+{
+  const char *p = (const char *)buffer;
+  while (length > 0)
+  {
+    ssize_t written = write(fd, p, length);
+    if (written < 0)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+      return -1;
+    }
+    p += written;
+    length -= (size_t)written;
+  }
+  return 0;
+}
+
+//* Write a matrix to a matrix file. The payload of a contiguous matrix goes out in a single write, a view row by row.
+// Returns 0 on success, or -1 with errno set.
+int saveMat(MAT *mat, const char *path)
+{
+  char page[MATFILE_ALIGNMENT];
+  MATHEADER header = headerOf(mat->x, mat->y);
+  memset(page, 0, sizeof(page));
+  memcpy(page, &header, sizeof(header));
+
+  int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+  {
+    return -1;
+  }
+  int result = writeAll(fd, page, sizeof(page));
+  if (mat->stride == mat->y || mat->x <= 1)
+  {
+    if (result == 0)
+      result = writeAll(fd, mat->v, (size_t)mat->x * mat->y * sizeof(int));
+  }
+  else
+  {
+    for (unsigned i = 0; result == 0 && i < mat->x; i++)
+    {
+      result = writeAll(fd, rowMat(mat, i), (size_t)mat->y * sizeof(int));
+    }
+  }
+  int error = errno;
+  if (close(fd) != 0 && result == 0)
+  {
+    return -1;
+  }
+  errno = error;
+  return result;
+}
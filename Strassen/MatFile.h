@@ -0,0 +1,45 @@
+#include <stdint.h>
+#include <stddef.h>
+
+// Binary matrix file: a MATHEADER, then from `offset` the elements row by row in the byte order of the writer.
+// The payload starts on a page boundary, so the file can be mapped into memory and used as a MAT without parsing.
+#define MATFILE_MAGIC "MATB"
+#define MATFILE_VERSION 1
+#define MATFILE_BYTE_ORDER 0x01020304u
+#define MATFILE_ALIGNMENT 4096
+
+// Element types; MAT is MATFILE_INT32, the others are those of Typed.h
+enum
+{
+  MATFILE_INT32 = 1,
+  MATFILE_INT64 = 2,
+  MATFILE_FLOAT = 3,
+  MATFILE_DOUBLE = 4,
+  MATFILE_MOD = 5
+};
+
+typedef struct
+{
+  char magic[4];      // MATFILE_MAGIC
+  uint32_t byteOrder; // MATFILE_BYTE_ORDER as the writer stores it
+  uint32_t version;   // MATFILE_VERSION
+  uint32_t type;      // 要素の型 element type
+  uint32_t rows;
+  uint32_t cols;
+  uint32_t stride;    // 行の間隔 elements from the start of a row to the start of the next
+  uint32_t alignment; // the payload starts at a multiple of this many bytes
+  uint64_t offset;    // 要素の開始位置 start of the payload in bytes
+} MATHEADER;
+
+// A matrix file mapped into memory
+typedef struct
+{
+  MAT mat;       // the payload
+  void *base;    // start of the mapping
+  size_t length; // length of the mapping
+} MATFILE;
+
+MATFILE *openMatFile(const char *path);
+MATFILE *createMatFile(const char *path, unsigned rows, unsigned cols);
+void closeMatFile(MATFILE *file);
+int saveMat(MAT *mat, const char *path);
@@ -13,6 +13,7 @@ MAT *newMat(unsigned sizeX, unsigned sizeY) {
 		errorMat("newMat: no more memory");
 	new->x = sizeX;
 	new->y = sizeY;
+	new->stride = sizeY;
 	if ( (new->v = (int *) calloc(sizeX*sizeY, sizeof(int))) == NULL  )
 		errorMat("newMat: too large");
 	return new;
@@ -23,16 +24,70 @@ void freeMat(MAT *mat) {
 	free(mat);
 }
 
+/* sizeX x sizeY submatrix starting at (top, left), sharing the elements of mat */
+MAT viewMat(MAT *mat, unsigned top, unsigned left, unsigned sizeX, unsigned sizeY) {
+	MAT view;
+	if ( top + sizeX > mat->x ) errorMat("viewMat: x is out of range");
+	if ( left + sizeY > mat->y ) errorMat("viewMat: y is out of range");
+	view.x = sizeX;
+	view.y = sizeY;
+	view.v = mat->v + (unsigned long) top * mat->stride + left;
+	view.stride = mat->stride;
+	return view;
+}
+
+ARENA *newArena(unsigned long size) {
+	ARENA *new;
+	if ( (new = (ARENA *) malloc(sizeof(ARENA))) == NULL )
+		errorMat("newArena: no more memory");
+	new->size = size;
+	new->used = 0;
+	if ( (new->base = (int *) malloc((size > 0 ? size : 1) * sizeof(int))) == NULL )
+		errorMat("newArena: too large");
+	return new;
+}
+
+void freeArena(ARENA *arena) {
+	free(arena->base);
+	free(arena);
+}
+
+/* the elements are not initialised */
+MAT allocArena(ARENA *arena, unsigned sizeX, unsigned sizeY) {
+	MAT mat;
+	unsigned long need = (unsigned long) sizeX * sizeY;
+	if ( arena->used + need > arena->size ) {
+		fprintf(stderr, "allocArena: the workspace is exhausted\n");
+		exit(EXIT_FAILURE);
+	}
+	mat.x = sizeX;
+	mat.y = sizeY;
+	mat.v = arena->base + arena->used;
+	mat.stride = sizeY;
+	arena->used += need;
+	return mat;
+}
+
+/* a row or block given to the bulk accessors is out of range */
+void rangeErrorMat(const char *where) {
+	fprintf(stderr, "%s\n", where);
+	exit(EXIT_FAILURE);
+}
+
 int getMat(MAT *mat, unsigned x, unsigned y) {
+#if MAT_CHECKED
 	if ( x >= mat->x ) errorMat("getMat: x is out of range");
 	if ( y >= mat->y ) errorMat("getMat: y is out of range");
-	return ( mat->v[x * mat->y + y]);
+#endif
+	return ( mat->v[(unsigned long) x * mat->stride + y]);
 }
 
 void setMat(MAT *mat, unsigned x, unsigned y, int val) {
+#if MAT_CHECKED
 	if ( x >= mat->x ) errorMat("setMat: x is out of range");
 	if ( y >= mat->y ) errorMat("setMat: y is out of range");
-	mat->v[x * mat->y + y] = val;
+#endif
+	mat->v[(unsigned long) x * mat->stride + y] = val;
 
 }
 
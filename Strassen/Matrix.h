@@ -2,17 +2,67 @@ typedef struct
 {
   unsigned x; // 行数 rows
   unsigned y; // 列数 columns
-  int *v;
+  int *v;     // 先頭要素 first element
+  unsigned stride; // 行の間隔 distance between the first elements of two rows (y unless the matrix is a view)
 } MAT;
 
 MAT *newMat(unsigned sizeX, unsigned sizeY);
 void freeMat(MAT *mat);
+MAT viewMat(MAT *mat, unsigned top, unsigned left, unsigned sizeX, unsigned sizeY);
+
+// Workspace for temporary matrices, allocated once and handed out like a stack.
+// Record `used` before allocating and restore it to release everything allocated since.
+typedef struct
+{
+  int *base;
+  unsigned long size; // number of elements in the block
+  unsigned long used; // number of elements handed out
+} ARENA;
+
+ARENA *newArena(unsigned long size);
+void freeArena(ARENA *arena);
+MAT allocArena(ARENA *arena, unsigned sizeX, unsigned sizeY);
 
 int getMat(MAT *mat, unsigned x, unsigned y);
 void setMat(MAT *mat, unsigned x, unsigned y, int val);
 
+// Bulk access for hot loops: a kernel checks its block once and then runs plain pointer loops over the rows.
+// The checks here and in getMat/setMat are on when MAT_CHECKED is 1, which is the default unless NDEBUG is defined.
+#ifndef MAT_CHECKED
+#ifdef NDEBUG
+#define MAT_CHECKED 0
+#else
+#define MAT_CHECKED 1
+#endif
+#endif
+
+void rangeErrorMat(const char *where);
+
+// Pointer to the first element of row x, which has mat->y elements
+static inline int *rowMat(MAT *mat, unsigned x)
+{
+#if MAT_CHECKED
+  if (x >= mat->x)
+    rangeErrorMat("rowMat: x is out of range");
+#endif
+  return mat->v + (unsigned long)x * mat->stride;
+}
+
+// Check that the rows x cols block at (top, left) lies inside the matrix
+static inline void checkBlockMat(MAT *mat, unsigned top, unsigned left, unsigned rows, unsigned cols)
+{
+#if MAT_CHECKED
+  if (top + rows > mat->x || left + cols > mat->y)
+    rangeErrorMat("checkBlockMat: the block is out of range");
+#else
+  (void)mat, (void)top, (void)left, (void)rows, (void)cols;
+#endif
+}
+
 void printMat(MAT *mat);
 
 void negateMatrix(MAT *src, MAT *dst);
 void addMatrix(MAT *matA, MAT *matB, MAT *matC);
+void subMatrix(MAT *matA, MAT *matB, MAT *matC);
+void combineMatrix(MAT *matA, MAT *matB, MAT *matC, MAT *matD, MAT *matE);
 void Strassen(MAT *matA, MAT *matB, MAT *matC);
@@ -0,0 +1,289 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "Matrix.h"
+#include "Strassen.h"
+#include "Morton.h"
+#include "Verify.h"
+
+// Deepest tiling mortonLevels() chooses
+#define MORTON_MAX_LEVELS 15
+
+static void errorMorton(char *str)
+{
+  perror(str);
+  exit(EXIT_FAILURE);
+}
+
+// Position of tile (i, j) in Morton order: the bits of i and j interleaved, those of i being the higher ones,
+// so that the quadrants 11, 12, 21 and 22 of every block follow each other
+static unsigned long mortonIndex(unsigned i, unsigned j, unsigned levels)
+{
+  unsigned long index = 0;
+  for (unsigned b = 0; b < levels; b++)
+  {
+    index |= (unsigned long)((i >> b) & 1) << (2 * b + 1) | (unsigned long)((j >> b) & 1) << (2 * b);
+  }
+  return index;
+}
+
+// All tiles of a matrix, stacked into one matrix of tileX << 2 * levels rows
+static MAT stackedOf(MORTON *mat)
+{
+  MAT stacked;
+  stacked.x = mat->tileX << 2 * mat->levels;
+  stacked.y = mat->tileY;
+  stacked.v = mat->v;
+  stacked.stride = mat->tileY;
+  return stacked;
+}
+
+//* Allocate a sizeX x sizeY tiled matrix split `levels` times, with tiles of ceil(sizeX / 2^levels) x ceil(sizeY / 2^levels).
+// The elements are not initialised.
+MORTON *newMorton(unsigned sizeX, unsigned sizeY, unsigned levels)
+{
+  MORTON *new;
+  if ((new = (MORTON *)malloc(sizeof(MORTON))) == NULL)
+  {
+    errorMorton("newMorton: no more memory");
+  }
+  new->x = sizeX;
+  new->y = sizeY;
+  new->levels = levels;
+  new->tileX = (unsigned)(((unsigned long)sizeX + (1ul << levels) - 1) >> levels);
+  new->tileY = (unsigned)(((unsigned long)sizeY + (1ul << levels) - 1) >> levels);
+  unsigned long size = (unsigned long)new->tileX * new->tileY << 2 * levels;
+  if ((new->v = (int *)malloc((size > 0 ? size : 1) * sizeof(int))) == NULL)
+  {
+    errorMorton("newMorton: too large");
+  }
+  return new;
+}
+
+void freeMorton(MORTON *mat)
+{
+  free(mat->v);
+  free(mat);
+}
+
+//* Number of levels to tile the matrices of an m x p by p x n product with: the recursion of Strassen() would stop at the tiles
+unsigned mortonLevels(unsigned m, unsigned p, unsigned n)
+{
+  unsigned levels = 0;
+  while (levels < MORTON_MAX_LEVELS &&
+         !isStrassenLeaf((m + (1u << levels) - 1) >> levels, (p + (1u << levels) - 1) >> levels, (n + (1u << levels) - 1) >> levels))
+  {
+    levels++;
+  }
+  return levels;
+}
+
+//* Copy a matrix into a tiled matrix of the same size, filling the padding with zeros
+void toMorton(MAT *src, MORTON *dst)
+{
+  if (src->x != dst->x || src->y != dst->y)
+  {
+    fprintf(stderr, "toMorton: the matrices differ in size\n");
+    exit(EXIT_FAILURE);
+  }
+  unsigned grid = 1u << dst->levels;
+  unsigned long tileSize = (unsigned long)dst->tileX * dst->tileY;
+  for (unsigned ti = 0; ti < grid; ti++)
+  {
+    for (unsigned tj = 0; tj < grid; tj++)
+    {
+      int *tile = dst->v + mortonIndex(ti, tj, dst->levels) * tileSize;
+      unsigned left = tj * dst->tileY;
+      unsigned cols = left >= src->y ? 0 : src->y - left < dst->tileY ? src->y - left : dst->tileY;
+      for (unsigned r = 0; r < dst->tileX; r++)
+      {
+        unsigned row = ti * dst->tileX + r;
+        int *t = tile + (unsigned long)r * dst->tileY;
+        unsigned copied = row < src->x ? cols : 0;
+        if (copied > 0)
+        {
+          memcpy(t, rowMat(src, row) + left, copied * sizeof(int));
+        }
+        memset(t + copied, 0, (dst->tileY - copied) * sizeof(int));
+      }
+    }
+  }
+}
+
+//* Copy a tiled matrix back into a matrix of the same size, leaving out the padding
+void fromMorton(MORTON *src, MAT *dst)
+{
+  if (src->x != dst->x || src->y != dst->y)
+  {
+    fprintf(stderr, "fromMorton: the matrices differ in size\n");
+    exit(EXIT_FAILURE);
+  }
+  unsigned grid = 1u << src->levels;
+  unsigned long tileSize = (unsigned long)src->tileX * src->tileY;
+  for (unsigned ti = 0; ti < grid; ti++)
+  {
+    for (unsigned tj = 0; tj < grid; tj++)
+    {
+      const int *tile = src->v + mortonIndex(ti, tj, src->levels) * tileSize;
+      unsigned left = tj * src->tileY;
+      if (left >= dst->y)
+      {
+        continue;
+      }
+      unsigned cols = dst->y - left < src->tileY ? dst->y - left : src->tileY;
+      for (unsigned r = 0; r < src->tileX && ti * src->tileX + r < dst->x; r++)
+      {
+        memcpy(rowMat(dst, ti * src->tileX + r) + left, tile + (unsigned long)r * src->tileY, cols * sizeof(int));
+      }
+    }
+  }
+}
+
+// Quadrant q (0: 11, 1: 12, 2: 21, 3: 22) of a block of stacked tiles, itself a contiguous block of a quarter of the tiles
+static MAT quadrantOf(MAT *mat, unsigned q)
+{
+  unsigned rows = mat->x / 4;
+  return viewMat(mat, q * rows, 0, rows, mat->y);
+}
+
+// Elements of workspace mortonRecursive() needs for tiles of tileM x tileP by tileP x tileN split `levels` times
+static unsigned long mortonWorkspace(unsigned tileM, unsigned tileP, unsigned tileN, unsigned levels)
+{
+  unsigned long size = 0, tiles = 1;
+  for (unsigned level = 1; level <= levels; level++, tiles *= 4)
+  {
+    size += tiles * (7ul * tileM * tileN + (unsigned long)tileM * tileP + (unsigned long)tileP * tileN);
+  }
+  return size;
+}
+
+// Strassen's algorithm on blocks of stacked tiles `level` levels above the tiles.
+// The operands and temporaries are contiguous, so the additions run over each of them in a single pass.
+static void mortonRecursive(MAT *matA, MAT *matB, MAT *matC, unsigned level, ARENA *arena)
+{
+  /* stop recursive call */
+  if (level == 0)
+  {
+    multiplyClassic(matA, matB, matC);
+    return;
+  }
+
+  /* divide */
+  MAT matA11 = quadrantOf(matA, 0);
+  MAT matA12 = quadrantOf(matA, 1);
+  MAT matA21 = quadrantOf(matA, 2);
+  MAT matA22 = quadrantOf(matA, 3);
+
+  MAT matB11 = quadrantOf(matB, 0);
+  MAT matB12 = quadrantOf(matB, 1);
+  MAT matB21 = quadrantOf(matB, 2);
+  MAT matB22 = quadrantOf(matB, 3);
+
+  MAT matC11 = quadrantOf(matC, 0);
+  MAT matC12 = quadrantOf(matC, 1);
+  MAT matC21 = quadrantOf(matC, 2);
+  MAT matC22 = quadrantOf(matC, 3);
+
+  /* allocate memory for temporal matrix */
+  unsigned long mark = arena->used;
+  MAT matP1 = allocArena(arena, matC11.x, matC11.y);
+  MAT matP2 = allocArena(arena, matC11.x, matC11.y);
+  MAT matP3 = allocArena(arena, matC11.x, matC11.y);
+  MAT matP4 = allocArena(arena, matC11.x, matC11.y);
+  MAT matP5 = allocArena(arena, matC11.x, matC11.y);
+  MAT matP6 = allocArena(arena, matC11.x, matC11.y);
+  MAT matP7 = allocArena(arena, matC11.x, matC11.y);
+  MAT matIntmA = allocArena(arena, matA11.x, matA11.y);
+  MAT matIntmB = allocArena(arena, matB11.x, matB11.y);
+
+  /* conquer */
+  // Calculate P1 = (A11 + A22) * (B11 + B22)
+  addMatrix(&matA11, &matA22, &matIntmA);
+  addMatrix(&matB11, &matB22, &matIntmB);
+  mortonRecursive(&matIntmA, &matIntmB, &matP1, level - 1, arena);
+
+  // Calculate P2 = (A21 + A22) * B11
+  addMatrix(&matA21, &matA22, &matIntmA);
+  mortonRecursive(&matIntmA, &matB11, &matP2, level - 1, arena);
+
+  // Calculate P3 = A11 * (B12 - B22)
+  subMatrix(&matB12, &matB22, &matIntmB);
+  mortonRecursive(&matA11, &matIntmB, &matP3, level - 1, arena);
+
+  // Calculate P4 = A22 * (B21 - B11)
+  subMatrix(&matB21, &matB11, &matIntmB);
+  mortonRecursive(&matA22, &matIntmB, &matP4, level - 1, arena);
+
+  // Calculate P5 = (A11 + A12) * B22
+  addMatrix(&matA11, &matA12, &matIntmA);
+  mortonRecursive(&matIntmA, &matB22, &matP5, level - 1, arena);
+
+  // Calculate P6 = (A21 - A11) * (B11 + B12)
+  subMatrix(&matA21, &matA11, &matIntmA);
+  addMatrix(&matB11, &matB12, &matIntmB);
+  mortonRecursive(&matIntmA, &matIntmB, &matP6, level - 1, arena);
+
+  // Calculate P7 = (A12 - A22) * (B21 + B22)
+  subMatrix(&matA12, &matA22, &matIntmA);
+  addMatrix(&matB21, &matB22, &matIntmB);
+  mortonRecursive(&matIntmA, &matIntmB, &matP7, level - 1, arena);
+
+  /* combine */
+  // Calculate C11 = P1 + P4 - P5 + P7
+  combineMatrix(&matP1, &matP4, &matP5, &matP7, &matC11);
+
+  // Calculate C12 = P3 + P5
+  addMatrix(&matP3, &matP5, &matC12);
+
+  // Calculate C21 = P2 + P4
+  addMatrix(&matP2, &matP4, &matC21);
+
+  // Calculate C22 = P1 - P2 + P3 + P6
+  combineMatrix(&matP1, &matP3, &matP2, &matP6, &matC22);
+
+  /* release memory for temporal matrix */
+  arena->used = mark;
+}
+
+//* Calculate the product of two tiled matrices (C = A * B) with Strassen's algorithm.
+// The three matrices must be split the same number of times, with tiles of matching shapes, as newMorton() makes them
+// for the levels of mortonLevels(). The padding of C comes out as zeros.
+void StrassenMorton(MORTON *matA, MORTON *matB, MORTON *matC)
+{
+  if (matA->y != matB->x || matC->x != matA->x || matC->y != matB->y ||
+      matA->levels != matB->levels || matC->levels != matA->levels ||
+      matA->tileY != matB->tileX || matC->tileX != matA->tileX || matC->tileY != matB->tileY)
+  {
+    fprintf(stderr, "StrassenMorton: the tilings of the matrices do not match\n");
+    exit(EXIT_FAILURE);
+  }
+  MAT stackedA = stackedOf(matA);
+  MAT stackedB = stackedOf(matB);
+  MAT stackedC = stackedOf(matC);
+  ARENA *arena = newArena(mortonWorkspace(matA->tileX, matA->tileY, matB->tileY, matA->levels));
+  mortonRecursive(&stackedA, &stackedB, &stackedC, matA->levels, arena);
+  freeArena(arena);
+}
+
+//* Calculate the product of two matrices (C = A * B) with Strassen's algorithm in the tiled layout.
+// The operands are converted to it and the product back from it, which pays off for large matrices.
+void StrassenTiled(MAT *matA, MAT *matB, MAT *matC)
+{
+  if (matA->y != matB->x || matC->x != matA->x || matC->y != matB->y)
+  {
+    printf("Error: The shapes of the matrices do not match.\n");
+    exit(1);
+  }
+  unsigned levels = mortonLevels(matA->x, matA->y, matB->y);
+  MORTON *tiledA = newMorton(matA->x, matA->y, levels);
+  MORTON *tiledB = newMorton(matB->x, matB->y, levels);
+  MORTON *tiledC = newMorton(matC->x, matC->y, levels);
+  toMorton(matA, tiledA);
+  toMorton(matB, tiledB);
+  StrassenMorton(tiledA, tiledB, tiledC);
+  fromMorton(tiledC, matC);
+  freeMorton(tiledA);
+  freeMorton(tiledB);
+  freeMorton(tiledC);
+  checkProduct(matA, matB, matC);
+}
@@ -0,0 +1,21 @@
+// Tiled matrix in Morton (Z) order: the matrix is padded with zeros to a 2^levels x 2^levels grid of tileX x tileY tiles,
+// which are stored one after another in Morton order, each of them row by row.
+// Every quadrant at every level of the recursion is then one contiguous range of tiles,
+// which reads as a (tiles * tileX) x tileY matrix stacking its tiles.
+typedef struct
+{
+  unsigned x;      // 行数 rows
+  unsigned y;      // 列数 columns
+  unsigned tileX;  // タイルの行数 rows of a tile
+  unsigned tileY;  // タイルの列数 columns of a tile
+  unsigned levels; // 分割の段数 the tiles form a 2^levels x 2^levels grid
+  int *v;          // 先頭のタイル first tile
+} MORTON;
+
+MORTON *newMorton(unsigned sizeX, unsigned sizeY, unsigned levels);
+void freeMorton(MORTON *mat);
+unsigned mortonLevels(unsigned m, unsigned p, unsigned n);
+void toMorton(MAT *src, MORTON *dst);
+void fromMorton(MORTON *src, MAT *dst);
+void StrassenMorton(MORTON *matA, MORTON *matB, MORTON *matC);
+void StrassenTiled(MAT *matA, MAT *matB, MAT *matC);
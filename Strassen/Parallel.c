@@ -0,0 +1,237 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include "Matrix.h"
+#include "Strassen.h"
+#include "Pool.h"
+
+// State shared by all tasks of one multiplication
+typedef struct
+{
+  POOL *pool;
+  unsigned depth; // 何段目まで並列化するか levels of the recursion which spawn tasks
+  ARENA **arenas; // workspace of every worker; that of worker 0 is the one multiplyRecursive() passes in
+} PARALLEL;
+
+// One of the seven products: P = (A1 op A2) * (B1 op B2),
+// where op is 1 for an addition, -1 for a subtraction and 0 when the operand is A1 (B1) alone
+typedef struct
+{
+  PARALLEL *par;
+  unsigned depth;
+  MAT matA1, matA2;
+  int opA;
+  MAT matB1, matB2;
+  int opB;
+  MAT matP;
+} PRODUCT;
+
+// Whether the level of an m x p by p x n product at depth `depth` spawns its products as tasks
+static int spawnsTasks(PARALLEL *par, unsigned m, unsigned p, unsigned n, unsigned depth)
+{
+  return depth < par->depth && !isStrassenLeaf(m, p, n);
+}
+
+static unsigned long productWorkspace(PARALLEL *par, unsigned m, unsigned p, unsigned n, unsigned depth);
+
+// Number of elements of workspace needed by parallelRecursive() on the worker that calls it.
+// A spawning level keeps the seven products, and its worker may run one of its own products while it waits.
+static unsigned long parallelWorkspace(PARALLEL *par, unsigned m, unsigned p, unsigned n, unsigned depth)
+{
+  if (!spawnsTasks(par, m, p, n, depth))
+  {
+    return strassenWorkspace(m, p, n);
+  }
+  return 7 * (unsigned long)(m / 2) * (n / 2) + productWorkspace(par, m / 2, p / 2, n / 2, depth + 1);
+}
+
+// Number of elements of workspace needed by a task computing an m x p by p x n product: its two operands and the multiplication
+static unsigned long productWorkspace(PARALLEL *par, unsigned m, unsigned p, unsigned n, unsigned depth)
+{
+  return (unsigned long)m * p + (unsigned long)p * n + parallelWorkspace(par, m, p, n, depth);
+}
+
+static void productTask(void *arg, unsigned worker);
+
+// Strassen's algorithm on matrices of any shape.
+// The levels above the depth cutoff hand the seven products to the pool; the levels below run strassenRecursive() on one worker.
+static void parallelRecursive(MAT *matA, MAT *matB, MAT *matC, ARENA *arena, PARALLEL *par, unsigned worker, unsigned depth)
+{
+  unsigned m = matA->x, p = matA->y, n = matB->y;
+  if (!spawnsTasks(par, m, p, n, depth))
+  {
+    strassenRecursive(matA, matB, matC, arena);
+    return;
+  }
+
+  /* divide */
+  unsigned halfM = m / 2, halfP = p / 2, halfN = n / 2;
+  MAT matA11 = viewMat(matA, 0, 0, halfM, halfP);
+  MAT matA12 = viewMat(matA, 0, halfP, halfM, halfP);
+  MAT matA21 = viewMat(matA, halfM, 0, halfM, halfP);
+  MAT matA22 = viewMat(matA, halfM, halfP, halfM, halfP);
+
+  MAT matB11 = viewMat(matB, 0, 0, halfP, halfN);
+  MAT matB12 = viewMat(matB, 0, halfN, halfP, halfN);
+  MAT matB21 = viewMat(matB, halfP, 0, halfP, halfN);
+  MAT matB22 = viewMat(matB, halfP, halfN, halfP, halfN);
+
+  MAT matC11 = viewMat(matC, 0, 0, halfM, halfN);
+  MAT matC12 = viewMat(matC, 0, halfN, halfM, halfN);
+  MAT matC21 = viewMat(matC, halfM, 0, halfM, halfN);
+  MAT matC22 = viewMat(matC, halfM, halfN, halfM, halfN);
+
+  unsigned long mark = arena->used;
+  MAT matP[7];
+  for (unsigned i = 0; i < 7; i++)
+  {
+    matP[i] = allocArena(arena, halfM, halfN);
+  }
+
+  /* conquer */
+  // Each task forms its own operands, so that the products do not share temporaries
+  PRODUCT products[7] = {
+      {par, depth + 1, matA11, matA22, 1, matB11, matB22, 1, matP[0]},  // P1 = (A11 + A22) * (B11 + B22)
+      {par, depth + 1, matA21, matA22, 1, matB11, matB11, 0, matP[1]},  // P2 = (A21 + A22) * B11
+      {par, depth + 1, matA11, matA11, 0, matB12, matB22, -1, matP[2]}, // P3 = A11 * (B12 - B22)
+      {par, depth + 1, matA22, matA22, 0, matB21, matB11, -1, matP[3]}, // P4 = A22 * (B21 - B11)
+      {par, depth + 1, matA11, matA12, 1, matB22, matB22, 0, matP[4]},  // P5 = (A11 + A12) * B22
+      {par, depth + 1, matA21, matA11, -1, matB11, matB12, 1, matP[5]}, // P6 = (A21 - A11) * (B11 + B12)
+      {par, depth + 1, matA12, matA22, -1, matB21, matB22, 1, matP[6]}, // P7 = (A12 - A22) * (B21 + B22)
+  };
+  TASKGROUP group = {0};
+  for (unsigned i = 0; i < 7; i++)
+  {
+    spawnTask(par->pool, worker, productTask, &products[i], &group);
+  }
+  waitTasks(par->pool, worker, &group);
+
+  /* combine */
+  combineMatrix(&matP[0], &matP[3], &matP[4], &matP[6], &matC11); // C11 = P1 + P4 - P5 + P7
+  addMatrix(&matP[2], &matP[4], &matC12);                          // C12 = P3 + P5
+  addMatrix(&matP[1], &matP[3], &matC21);                          // C21 = P2 + P4
+  combineMatrix(&matP[0], &matP[2], &matP[1], &matP[5], &matC22); // C22 = P1 - P2 + P3 + P6
+
+  arena->used = mark;
+
+  /* peel */
+  peelMatrix(matA, matB, matC);
+}
+
+// Form an operand of a product into `dst`, or return the single matrix it consists of
+static MAT formOperand(MAT *mat1, MAT *mat2, int op, ARENA *arena)
+{
+  if (op == 0)
+  {
+    return *mat1;
+  }
+  MAT dst = allocArena(arena, mat1->x, mat1->y);
+  if (op > 0)
+  {
+    addMatrix(mat1, mat2, &dst);
+  }
+  else
+  {
+    subMatrix(mat1, mat2, &dst);
+  }
+  return dst;
+}
+
+// Task computing one product on the workspace of the worker that runs it.
+// A worker which runs a task while waiting for its own ones stacks it on top of its workspace;
+// only when that does not fit, the task gets a workspace of its own.
+static void productTask(void *arg, unsigned worker)
+{
+  PRODUCT *product = (PRODUCT *)arg;
+  PARALLEL *par = product->par;
+  unsigned m = product->matA1.x, p = product->matA1.y, n = product->matB1.y;
+  ARENA *arena = par->arenas[worker];
+  ARENA *ownArena = NULL;
+  unsigned long need = productWorkspace(par, m, p, n, product->depth);
+  if (arena->size - arena->used < need)
+  {
+    ownArena = newArena(need);
+    arena = ownArena;
+  }
+
+  unsigned long mark = arena->used;
+  MAT matA = formOperand(&product->matA1, &product->matA2, product->opA, arena);
+  MAT matB = formOperand(&product->matB1, &product->matB2, product->opB, arena);
+  parallelRecursive(&matA, &matB, &product->matP, arena, par, worker, product->depth);
+  arena->used = mark;
+
+  if (ownArena != NULL)
+  {
+    freeArena(ownArena);
+  }
+}
+
+// Entry of the recursion for multiplyRecursive(): give the workers 1, 2, ... a workspace large enough
+// for the tasks at the deepest spawning level, which are most of the tasks they steal
+static void parallelTop(MAT *matA, MAT *matB, MAT *matC, ARENA *arena, void *ctx)
+{
+  PARALLEL *par = (PARALLEL *)ctx;
+  unsigned threads = sizePool(par->pool);
+  unsigned leafM = matA->x, leafP = matA->y, leafN = matB->y;
+  unsigned leafDepth = 0;
+  while (spawnsTasks(par, leafM, leafP, leafN, leafDepth))
+  {
+    leafM /= 2;
+    leafP /= 2;
+    leafN /= 2;
+    leafDepth++;
+  }
+  unsigned long leafNeed = leafDepth > 0 ? productWorkspace(par, leafM, leafP, leafN, leafDepth) : 0;
+
+  par->arenas[0] = arena;
+  for (unsigned t = 1; t < threads; t++)
+  {
+    par->arenas[t] = newArena(leafNeed);
+  }
+  parallelRecursive(matA, matB, matC, arena, par, 0, 0);
+  for (unsigned t = 1; t < threads; t++)
+  {
+    freeArena(par->arenas[t]);
+  }
+}
+
+static unsigned long parallelTopWorkspace(unsigned m, unsigned p, unsigned n, void *ctx)
+{
+  return parallelWorkspace((PARALLEL *)ctx, m, p, n, 0);
+}
+
+//* Calculate the product of two matrices (C = A * B) using Strassen's algorithm on `threads` threads (0 means one per online core).
+// The seven products of the upper levels of the recursion, and recursively their products, are tasks of a work-stealing pool.
+// Tasks are spawned until there are about STRASSEN_TASKS_PER_THREAD per thread, and each thread has its own workspace.
+void StrassenParallel(MAT *matA, MAT *matB, MAT *matC, unsigned threads)
+{
+  if (threads == 0)
+  {
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    threads = online > 0 ? (unsigned)online : 1;
+  }
+  if (threads <= 1)
+  {
+    Strassen(matA, matB, matC);
+    return;
+  }
+
+  // Every spawning level multiplies the number of tasks by seven
+  unsigned depth = 0;
+  for (unsigned long tasks = 1; tasks < (unsigned long)STRASSEN_TASKS_PER_THREAD * threads; tasks *= 7)
+  {
+    depth++;
+  }
+
+  PARALLEL par;
+  par.pool = newPool(threads);
+  par.depth = depth;
+  if ((par.arenas = (ARENA **)calloc(threads, sizeof(ARENA *))) == NULL)
+  {
+    perror("StrassenParallel: no more memory");
+    exit(EXIT_FAILURE);
+  }
+  multiplyRecursive(matA, matB, matC, parallelTop, parallelTopWorkspace, &par);
+  freePool(par.pool);
+  free(par.arenas);
+}
@@ -0,0 +1,215 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <pthread.h>
+#include <sched.h>
+#include "Pool.h"
+
+// Deque of one worker, guarded by its own lock
+typedef struct
+{
+  pthread_mutex_t lock;
+  TASK *tasks;
+  unsigned long top;    // 次に盗まれるタスク oldest task, taken by thieves
+  unsigned long bottom; // 次に積む位置 where the owner pushes and pops
+  unsigned long size;
+} DEQUE;
+
+struct POOL
+{
+  unsigned threads;
+  pthread_t *ids;
+  DEQUE *deques;
+  unsigned long queued; // 全ての deque にあるタスク数 tasks waiting in all deques
+  int stop;
+  pthread_mutex_t lock; // guards the sleep of idle workers
+  pthread_cond_t wake;
+};
+
+// Argument of a worker thread
+typedef struct
+{
+  POOL *pool;
+  unsigned worker;
+} WORKER;
+
+static void errorPool(char *str)
+{
+  perror(str);
+  exit(EXIT_FAILURE);
+}
+
+static void pushDeque(DEQUE *deque, TASK task)
+{
+  pthread_mutex_lock(&deque->lock);
+  if (deque->bottom == deque->size)
+  {
+    // Move the live tasks to the front before growing
+    unsigned long live = deque->bottom - deque->top;
+    for (unsigned long i = 0; i < live; i++)
+    {
+      deque->tasks[i] = deque->tasks[deque->top + i];
+    }
+    deque->top = 0;
+    deque->bottom = live;
+    if (live == deque->size)
+    {
+      deque->size = deque->size > 0 ? 2 * deque->size : 64;
+      if ((deque->tasks = (TASK *)realloc(deque->tasks, sizeof(TASK) * deque->size)) == NULL)
+      {
+        errorPool("spawnTask: no more memory");
+      }
+    }
+  }
+  deque->tasks[deque->bottom++] = task;
+  pthread_mutex_unlock(&deque->lock);
+}
+
+// Take the newest task of the deque (its owner) or the oldest one (a thief); return 0 if it is empty
+static int popDeque(DEQUE *deque, TASK *task, int steal)
+{
+  int found = 0;
+  pthread_mutex_lock(&deque->lock);
+  if (deque->top < deque->bottom)
+  {
+    *task = steal ? deque->tasks[deque->top++] : deque->tasks[--deque->bottom];
+    found = 1;
+  }
+  pthread_mutex_unlock(&deque->lock);
+  return found;
+}
+
+// Run one task: the newest of our own deque, else one stolen from another worker; return 0 if there is none
+static int runTask(POOL *pool, unsigned worker)
+{
+  TASK task;
+  int found = popDeque(&pool->deques[worker], &task, 0);
+  for (unsigned i = 1; !found && i < pool->threads; i++)
+  {
+    found = popDeque(&pool->deques[(worker + i) % pool->threads], &task, 1);
+  }
+  if (!found)
+  {
+    return 0;
+  }
+  __atomic_sub_fetch(&pool->queued, 1, __ATOMIC_SEQ_CST);
+  task.fn(task.arg, worker);
+  __atomic_sub_fetch(&task.group->pending, 1, __ATOMIC_RELEASE);
+  return 1;
+}
+
+// Workers other than 0 run tasks until the pool is freed, and sleep while there is nothing to do
+static void *runWorker(void *arg)
+{
+  WORKER *self = (WORKER *)arg;
+  POOL *pool = self->pool;
+  for (;;)
+  {
+    if (runTask(pool, self->worker))
+    {
+      continue;
+    }
+    pthread_mutex_lock(&pool->lock);
+    while (!pool->stop && __atomic_load_n(&pool->queued, __ATOMIC_SEQ_CST) == 0)
+    {
+      pthread_cond_wait(&pool->wake, &pool->lock);
+    }
+    int stop = pool->stop;
+    pthread_mutex_unlock(&pool->lock);
+    if (stop)
+    {
+      break;
+    }
+  }
+  free(self);
+  return NULL;
+}
+
+//* Create a pool of `threads` workers, the calling thread being worker 0
+POOL *newPool(unsigned threads)
+{
+  POOL *pool;
+  if (threads == 0)
+  {
+    threads = 1;
+  }
+  if ((pool = (POOL *)malloc(sizeof(POOL))) == NULL)
+    errorPool("newPool: no more memory");
+  if ((pool->ids = (pthread_t *)malloc(sizeof(pthread_t) * threads)) == NULL)
+    errorPool("newPool: no more memory");
+  if ((pool->deques = (DEQUE *)calloc(threads, sizeof(DEQUE))) == NULL)
+    errorPool("newPool: no more memory");
+  pool->threads = threads;
+  pool->queued = 0;
+  pool->stop = 0;
+  pthread_mutex_init(&pool->lock, NULL);
+  pthread_cond_init(&pool->wake, NULL);
+  for (unsigned t = 0; t < threads; t++)
+  {
+    pthread_mutex_init(&pool->deques[t].lock, NULL);
+  }
+  for (unsigned t = 1; t < threads; t++)
+  {
+    WORKER *self;
+    if ((self = (WORKER *)malloc(sizeof(WORKER))) == NULL)
+      errorPool("newPool: no more memory");
+    self->pool = pool;
+    self->worker = t;
+    if (pthread_create(&pool->ids[t], NULL, runWorker, self) != 0)
+      errorPool("newPool: cannot create a thread");
+  }
+  return pool;
+}
+
+//* Stop the workers and free the pool; no task may be pending
+void freePool(POOL *pool)
+{
+  pthread_mutex_lock(&pool->lock);
+  pool->stop = 1;
+  pthread_cond_broadcast(&pool->wake);
+  pthread_mutex_unlock(&pool->lock);
+  for (unsigned t = 1; t < pool->threads; t++)
+  {
+    pthread_join(pool->ids[t], NULL);
+  }
+  for (unsigned t = 0; t < pool->threads; t++)
+  {
+    pthread_mutex_destroy(&pool->deques[t].lock);
+    free(pool->deques[t].tasks);
+  }
+  pthread_mutex_destroy(&pool->lock);
+  pthread_cond_destroy(&pool->wake);
+  free(pool->deques);
+  free(pool->ids);
+  free(pool);
+}
+
+//* Number of workers, including the thread that created the pool
+unsigned sizePool(POOL *pool)
+{
+  return pool->threads;
+}
+
+//* Queue fn(arg) on the deque of `worker`, the thread calling this function, as a member of `group`
+void spawnTask(POOL *pool, unsigned worker, TASKFN fn, void *arg, TASKGROUP *group)
+{
+  TASK task = {fn, arg, group};
+  __atomic_add_fetch(&group->pending, 1, __ATOMIC_RELAXED);
+  // Count the task before it can be taken, so that `queued` never goes below zero
+  __atomic_add_fetch(&pool->queued, 1, __ATOMIC_SEQ_CST);
+  pushDeque(&pool->deques[worker], task);
+  pthread_mutex_lock(&pool->lock);
+  pthread_cond_signal(&pool->wake);
+  pthread_mutex_unlock(&pool->lock);
+}
+
+//* Wait until every task of `group` has finished, running queued tasks in the meantime
+void waitTasks(POOL *pool, unsigned worker, TASKGROUP *group)
+{
+  while (__atomic_load_n(&group->pending, __ATOMIC_ACQUIRE) > 0)
+  {
+    if (!runTask(pool, worker))
+    {
+      sched_yield();
+    }
+  }
+}
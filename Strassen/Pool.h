@@ -0,0 +1,26 @@
+// Work-stealing thread pool.
+// Every worker owns a deque of tasks: it pushes and pops at the bottom, and idle workers steal from the top of the others.
+// Worker 0 is the thread that created the pool, which takes part in the work while it waits for its tasks.
+
+typedef void (*TASKFN)(void *arg, unsigned worker);
+
+// Tasks which a thread waits for together
+typedef struct
+{
+  unsigned long pending; // 未完了のタスク数 tasks not finished yet
+} TASKGROUP;
+
+typedef struct
+{
+  TASKFN fn;
+  void *arg;
+  TASKGROUP *group;
+} TASK;
+
+typedef struct POOL POOL;
+
+POOL *newPool(unsigned threads);
+void freePool(POOL *pool);
+unsigned sizePool(POOL *pool);
+void spawnTask(POOL *pool, unsigned worker, TASKFN fn, void *arg, TASKGROUP *group);
+void waitTasks(POOL *pool, unsigned worker, TASKGROUP *group);
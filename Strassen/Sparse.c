@@ -0,0 +1,440 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "Matrix.h"
+#include "Strassen.h"
+#include "Chain.h"
+#include "Pool.h"
+#include "Sparse.h"
+#include "Verify.h"
+
+static void errorSparse(char *str)
+{
+  perror(str);
+  exit(EXIT_FAILURE);
+}
+
+//* Allocate a sizeX x sizeY sparse matrix with room for `nonzeros` elements; the row starts are zero
+SPARSE *newSparse(unsigned sizeX, unsigned sizeY, unsigned long nonzeros)
+{
+  SPARSE *new;
+  if ((new = (SPARSE *)malloc(sizeof(SPARSE))) == NULL)
+  {
+    errorSparse("newSparse: no more memory");
+  }
+  new->x = sizeX;
+  new->y = sizeY;
+  new->nonzeros = nonzeros;
+  if ((new->start = (unsigned long *)calloc((unsigned long)sizeX + 1, sizeof(unsigned long))) == NULL ||
+      (new->col = (unsigned *)malloc((nonzeros > 0 ? nonzeros : 1) * sizeof(unsigned))) == NULL ||
+      (new->v = (int *)malloc((nonzeros > 0 ? nonzeros : 1) * sizeof(int))) == NULL)
+  {
+    errorSparse("newSparse: too large");
+  }
+  return new;
+}
+
+void freeSparse(SPARSE *mat)
+{
+  free(mat->start);
+  free(mat->col);
+  free(mat->v);
+  free(mat);
+}
+
+//* Convert a matrix to a sparse matrix holding its nonzero elements
+SPARSE *toSparse(MAT *mat)
+{
+  unsigned long nonzeros = 0;
+  for (unsigned i = 0; i < mat->x; i++)
+  {
+    const int *row = rowMat(mat, i);
+    for (unsigned j = 0; j < mat->y; j++)
+    {
+      nonzeros += row[j] != 0;
+    }
+  }
+  SPARSE *sparse = newSparse(mat->x, mat->y, nonzeros);
+  unsigned long e = 0;
+  for (unsigned i = 0; i < mat->x; i++)
+  {
+    const int *row = rowMat(mat, i);
+    for (unsigned j = 0; j < mat->y; j++)
+    {
+      if (row[j] != 0)
+      {
+        sparse->col[e] = j;
+        sparse->v[e] = row[j];
+        e++;
+      }
+    }
+    sparse->start[i + 1] = e;
+  }
+  return sparse;
+}
+
+//* Copy a sparse matrix into a matrix of the same size
+void fromSparse(SPARSE *src, MAT *dst)
+{
+  if (src->x != dst->x || src->y != dst->y)
+  {
+    printf("Error: The matrices must have the same number of rows and columns.\n");
+    exit(1);
+  }
+  for (unsigned i = 0; i < dst->x; i++)
+  {
+    int *row = rowMat(dst, i);
+    memset(row, 0, (size_t)dst->y * sizeof(int));
+    for (unsigned long e = src->start[i]; e < src->start[i + 1]; e++)
+    {
+      row[src->col[e]] = src->v[e];
+    }
+  }
+}
+
+//* Fraction of the elements of a matrix which are not zero
+double densityMat(MAT *mat)
+{
+  if (mat->x == 0 || mat->y == 0)
+  {
+    return 0;
+  }
+  unsigned long nonzeros = 0;
+  for (unsigned i = 0; i < mat->x; i++)
+  {
+    const int *row = rowMat(mat, i);
+    for (unsigned j = 0; j < mat->y; j++)
+    {
+      nonzeros += row[j] != 0;
+    }
+  }
+  return (double)nonzeros / ((double)mat->x * mat->y);
+}
+
+// Sparse accumulator of one worker, holding a row of the product as it is summed:
+// column j has been touched in row i when mark[j] is i + 1, and the columns touched are listed in `touched`
+typedef struct
+{
+  int *value;
+  unsigned *mark;
+  unsigned *touched;
+} ACCUMULATOR;
+
+// State shared by the tasks of one sparse product
+typedef struct
+{
+  SPARSE *matA, *matB;
+  MAT *matC;                 // destination of multiplySparseMat(), NULL for multiplySparse()
+  ACCUMULATOR *accumulators; // one per worker
+  unsigned long *counts;     // 各行の要素数 number of elements of each row of the product
+} SPGEMM;
+
+// Rows first to last - 1 of the product; multiplySparse() collects the elements of its rows in col and v
+typedef struct
+{
+  SPGEMM *gemm;
+  unsigned first, last;
+  unsigned long size, capacity;
+  unsigned *col;
+  int *v;
+} ROWTASK;
+
+static int compareColumns(const void *a, const void *b)
+{
+  unsigned x = *(const unsigned *)a, y = *(const unsigned *)b;
+  return x < y ? -1 : x > y;
+}
+
+// Gustavson's algorithm: row i of C is the sum of the rows k of B scaled by the elements (i, k) of A
+static void sparseRows(ROWTASK *task, ACCUMULATOR *acc)
+{
+  SPARSE *matA = task->gemm->matA, *matB = task->gemm->matB;
+  unsigned n = matB->y;
+  for (unsigned i = task->first; i < task->last; i++)
+  {
+    unsigned touched = 0;
+    for (unsigned long ea = matA->start[i]; ea < matA->start[i + 1]; ea++)
+    {
+      unsigned k = matA->col[ea];
+      int a = matA->v[ea];
+      for (unsigned long eb = matB->start[k]; eb < matB->start[k + 1]; eb++)
+      {
+        unsigned j = matB->col[eb];
+        if (acc->mark[j] != i + 1)
+        {
+          acc->mark[j] = i + 1;
+          acc->value[j] = 0;
+          acc->touched[touched++] = j;
+        }
+        acc->value[j] += a * matB->v[eb];
+      }
+    }
+
+    // Put the columns in order: by sorting them when they are few, and by a scan of the marks otherwise
+    if ((unsigned long)touched * 16 < n)
+    {
+      qsort(acc->touched, touched, sizeof(unsigned), compareColumns);
+    }
+    else
+    {
+      touched = 0;
+      for (unsigned j = 0; j < n; j++)
+      {
+        if (acc->mark[j] == i + 1)
+        {
+          acc->touched[touched++] = j;
+        }
+      }
+    }
+
+    if (task->size + touched > task->capacity)
+    {
+      unsigned long capacity = task->capacity * 2 > task->size + touched ? task->capacity * 2 : task->size + touched;
+      if ((task->col = (unsigned *)realloc(task->col, capacity * sizeof(unsigned))) == NULL ||
+          (task->v = (int *)realloc(task->v, capacity * sizeof(int))) == NULL)
+      {
+        errorSparse("multiplySparse: no more memory");
+      }
+      task->capacity = capacity;
+    }
+    unsigned long count = 0;
+    for (unsigned t = 0; t < touched; t++)
+    {
+      unsigned j = acc->touched[t];
+      // Elements which cancel out are not stored
+      if (acc->value[j] != 0)
+      {
+        task->col[task->size + count] = j;
+        task->v[task->size + count] = acc->value[j];
+        count++;
+      }
+    }
+    task->size += count;
+    task->gemm->counts[i] = count;
+  }
+}
+
+// The same product into a matrix, whose rows are themselves the accumulators
+static void denseRows(ROWTASK *task)
+{
+  SPARSE *matA = task->gemm->matA, *matB = task->gemm->matB;
+  MAT *matC = task->gemm->matC;
+  for (unsigned i = task->first; i < task->last; i++)
+  {
+    int *c = rowMat(matC, i);
+    memset(c, 0, (size_t)matC->y * sizeof(int));
+    for (unsigned long ea = matA->start[i]; ea < matA->start[i + 1]; ea++)
+    {
+      unsigned k = matA->col[ea];
+      int a = matA->v[ea];
+      for (unsigned long eb = matB->start[k]; eb < matB->start[k + 1]; eb++)
+      {
+        c[matB->col[eb]] += a * matB->v[eb];
+      }
+    }
+  }
+}
+
+static void rowTask(void *arg, unsigned worker)
+{
+  ROWTASK *task = (ROWTASK *)arg;
+  if (task->gemm->matC != NULL)
+  {
+    denseRows(task);
+  }
+  else
+  {
+    sparseRows(task, &task->gemm->accumulators[worker]);
+  }
+}
+
+// Split the rows of the product into tasks with about the same number of multiply-adds and run them on `threads` threads
+static ROWTASK *runRowTasks(SPGEMM *gemm, unsigned threads, unsigned *tasksOut)
+{
+  SPARSE *matA = gemm->matA, *matB = gemm->matB;
+  unsigned m = matA->x;
+  unsigned tasks = threads > 1 ? SPARSE_TASKS_PER_THREAD * threads : 1;
+  if (tasks > m)
+  {
+    tasks = m > 0 ? m : 1;
+  }
+  ROWTASK *rows;
+  if ((rows = (ROWTASK *)calloc(tasks, sizeof(ROWTASK))) == NULL)
+  {
+    errorSparse("runRowTasks: no more memory");
+  }
+
+  // The work of row i is the number of elements of the rows of B it adds up
+  unsigned long total = 0;
+  for (unsigned long e = 0; e < matA->start[m]; e++)
+  {
+    total += matB->start[matA->col[e] + 1] - matB->start[matA->col[e]];
+  }
+  unsigned long work = 0;
+  unsigned i = 0;
+  for (unsigned t = 0; t < tasks; t++)
+  {
+    rows[t].gemm = gemm;
+    rows[t].first = i;
+    unsigned long goal = total / tasks * (t + 1);
+    while (i < m && (t + 1 == tasks || work < goal))
+    {
+      for (unsigned long e = matA->start[i]; e < matA->start[i + 1]; e++)
+      {
+        work += matB->start[matA->col[e] + 1] - matB->start[matA->col[e]];
+      }
+      i++;
+    }
+    rows[t].last = i;
+  }
+
+  if (tasks == 1)
+  {
+    rowTask(&rows[0], 0);
+  }
+  else
+  {
+    POOL *pool = newPool(threads);
+    TASKGROUP group = {0};
+    for (unsigned t = 0; t < tasks; t++)
+    {
+      spawnTask(pool, 0, rowTask, &rows[t], &group);
+    }
+    waitTasks(pool, 0, &group);
+    freePool(pool);
+  }
+  *tasksOut = tasks;
+  return rows;
+}
+
+// Number of threads to use, 0 meaning one per online core
+static unsigned threadsOf(unsigned threads)
+{
+  if (threads == 0)
+  {
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    threads = online > 0 ? (unsigned)online : 1;
+  }
+  return threads;
+}
+
+// The number of columns of A must be that of rows of B
+static void checkInner(unsigned p, unsigned rowsB)
+{
+  if (p != rowsB)
+  {
+    printf("Error: The number of columns of matrix A must be equal to the number of rows of matrix B.\n");
+    exit(1);
+  }
+}
+
+//* Calculate the product of two sparse matrices (C = A * B) with Gustavson's algorithm on `threads` threads
+// (0 means one per online core). Every thread sums the rows of the product in its own sparse accumulator.
+SPARSE *multiplySparse(SPARSE *matA, SPARSE *matB, unsigned threads)
+{
+  checkInner(matA->y, matB->x);
+  threads = threadsOf(threads);
+  unsigned n = matB->y;
+  SPGEMM gemm = {matA, matB, NULL, NULL, NULL};
+  if ((gemm.accumulators = (ACCUMULATOR *)calloc(threads, sizeof(ACCUMULATOR))) == NULL ||
+      (gemm.counts = (unsigned long *)calloc((unsigned long)matA->x + 1, sizeof(unsigned long))) == NULL)
+  {
+    errorSparse("multiplySparse: no more memory");
+  }
+  for (unsigned t = 0; t < threads; t++)
+  {
+    if ((gemm.accumulators[t].value = (int *)malloc((n > 0 ? n : 1) * sizeof(int))) == NULL ||
+        (gemm.accumulators[t].mark = (unsigned *)calloc(n > 0 ? n : 1, sizeof(unsigned))) == NULL ||
+        (gemm.accumulators[t].touched = (unsigned *)malloc((n > 0 ? n : 1) * sizeof(unsigned))) == NULL)
+    {
+      errorSparse("multiplySparse: no more memory");
+    }
+  }
+
+  unsigned tasks;
+  ROWTASK *rows = runRowTasks(&gemm, threads, &tasks);
+
+  // Put the rows of the tasks together; the tasks cover the rows in order
+  unsigned long nonzeros = 0;
+  for (unsigned t = 0; t < tasks; t++)
+  {
+    nonzeros += rows[t].size;
+  }
+  SPARSE *matC = newSparse(matA->x, n, nonzeros);
+  for (unsigned i = 0; i < matA->x; i++)
+  {
+    matC->start[i + 1] = matC->start[i] + gemm.counts[i];
+  }
+  for (unsigned t = 0; t < tasks; t++)
+  {
+    if (rows[t].size > 0)
+    {
+      memcpy(matC->col + matC->start[rows[t].first], rows[t].col, rows[t].size * sizeof(unsigned));
+      memcpy(matC->v + matC->start[rows[t].first], rows[t].v, rows[t].size * sizeof(int));
+    }
+    free(rows[t].col);
+    free(rows[t].v);
+  }
+  free(rows);
+  for (unsigned t = 0; t < threads; t++)
+  {
+    free(gemm.accumulators[t].value);
+    free(gemm.accumulators[t].mark);
+    free(gemm.accumulators[t].touched);
+  }
+  free(gemm.accumulators);
+  free(gemm.counts);
+  return matC;
+}
+
+//* Calculate the product of two sparse matrices into a matrix (C = A * B) on `threads` threads (0 means one per online core)
+void multiplySparseMat(SPARSE *matA, SPARSE *matB, MAT *matC, unsigned threads)
+{
+  checkInner(matA->y, matB->x);
+  if (matC->x != matA->x || matC->y != matB->y)
+  {
+    printf("Error: Matrix C must have as many rows as matrix A and as many columns as matrix B.\n");
+    exit(1);
+  }
+  SPGEMM gemm = {matA, matB, matC, NULL, NULL};
+  unsigned tasks;
+  free(runRowTasks(&gemm, threadsOf(threads), &tasks));
+}
+
+//* Calculate the product of two matrices (C = A * B) by the cheapest of three methods, on `threads` threads
+// (0 means one per online core): the classical algorithm below the crossover of Strassen's algorithm, the sparse product when
+// the densities of A and B make its multiply-adds (SPARSE_COST_FACTOR times dearer) and conversions cost less than
+// strassenCost(), and Strassen's algorithm otherwise. The product is verified whichever is taken when verifyRounds is set.
+void multiplyMat(MAT *matA, MAT *matB, MAT *matC, unsigned threads)
+{
+  unsigned m = matA->x, p = matA->y, n = matB->y;
+  checkInner(p, matB->x);
+  if (matC->x != m || matC->y != n)
+  {
+    printf("Error: Matrix C must have as many rows as matrix A and as many columns as matrix B.\n");
+    exit(1);
+  }
+  if (isStrassenLeaf(m, p, n))
+  {
+    multiplyClassic(matA, matB, matC);
+    checkProduct(matA, matB, matC);
+    return;
+  }
+
+  double densityA = densityMat(matA), densityB = densityMat(matB);
+  double sparseCost = SPARSE_COST_FACTOR * densityA * densityB * m * p * n + (double)m * p + (double)p * n + (double)m * n;
+  if (sparseCost < strassenCost(m, p, n))
+  {
+    SPARSE *sparseA = toSparse(matA);
+    SPARSE *sparseB = toSparse(matB);
+    multiplySparseMat(sparseA, sparseB, matC, threads);
+    freeSparse(sparseA);
+    freeSparse(sparseB);
+    checkProduct(matA, matB, matC);
+  }
+  else
+  {
+    StrassenParallel(matA, matB, matC, threads);
+  }
+}
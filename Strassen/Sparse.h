@@ -0,0 +1,25 @@
+// Sparse matrix in compressed sparse row (CSR) form: the nonzero elements row by row, each row in increasing column order
+typedef struct
+{
+  unsigned x;             // 行数 rows
+  unsigned y;             // 列数 columns
+  unsigned long nonzeros; // 非零要素の数 number of stored elements
+  unsigned long *start;   // 各行の開始位置 row i holds elements start[i] to start[i + 1] - 1; x + 1 entries
+  unsigned *col;          // 列番号 column of each element
+  int *v;                 // 値 value of each element
+} SPARSE;
+
+// multiplyMat() takes the sparse path when this many times the multiply-adds of the sparse product,
+// plus the conversions, cost less than Strassen's algorithm: an indirect multiply-add is dearer than a dense one
+#define SPARSE_COST_FACTOR 4
+// multiplySparse() and multiplySparseMat() split the rows into about this many tasks per thread
+#define SPARSE_TASKS_PER_THREAD 4
+
+SPARSE *newSparse(unsigned sizeX, unsigned sizeY, unsigned long nonzeros);
+void freeSparse(SPARSE *mat);
+SPARSE *toSparse(MAT *mat);
+void fromSparse(SPARSE *src, MAT *dst);
+double densityMat(MAT *mat);
+SPARSE *multiplySparse(SPARSE *matA, SPARSE *matB, unsigned threads);
+void multiplySparseMat(SPARSE *matA, SPARSE *matB, MAT *matC, unsigned threads);
+void multiplyMat(MAT *matA, MAT *matB, MAT *matC, unsigned threads);
@@ -1,61 +1,205 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include "Matrix.h"
+#include "Strassen.h"
+#include "Verify.h"
 
-// This function copies a submatrix from one matrix into another matrix. It copies the submatrix of src starting at row srcTop and column srcLeft into the submatrix of dst starting at row dstTop and column dstLeft. It copies rows rows and columns columns.
-// If the source matrix is too small, then just pad the destination matrix with zeros
-// If the destionation matrix is too small, then truncate the source matrix
-void copyMatrix(MAT *src, unsigned srcTop, unsigned srcLeft, MAT *dst, unsigned dstTop, unsigned dstLeft, unsigned rows, unsigned columns)
+// Side of the square matrices below which Strassen() switches to the classical algorithm
+unsigned strassenCutoff = STRASSEN_CUTOFF;
+
+//* Calculate the product of two matrices (C = A * B) with the classical algorithm.
+// C is computed in blocks of GEMM_BLOCK_K x GEMM_BLOCK_N of B, which stay in cache while every row of A
+// passes over them, and four rows of C are updated together so that each element of B loaded is used four times.
+void multiplyClassic(MAT *matA, MAT *matB, MAT *matC)
 {
-  // Copy elements from src to dst
-  for (unsigned i = 0; i < rows; i++)
+  unsigned m = matA->x;
+  unsigned p = matA->y;
+  unsigned n = matB->y;
+  checkBlockMat(matB, 0, 0, p, n);
+  checkBlockMat(matC, 0, 0, m, n);
+  for (unsigned i = 0; i < m; i++)
   {
-    for (unsigned j = 0; j < columns; j++)
+    int *c = rowMat(matC, i);
+    for (unsigned j = 0; j < n; j++)
     {
-      // If the source element is out of range, then just pad the destination element with zero
-      if (srcTop + i >= src->x || srcLeft + j >= src->y)
+      c[j] = 0;
+    }
+  }
+
+  for (unsigned kk = 0; kk < p; kk += GEMM_BLOCK_K)
+  {
+    unsigned kEnd = kk + GEMM_BLOCK_K < p ? kk + GEMM_BLOCK_K : p;
+    for (unsigned jj = 0; jj < n; jj += GEMM_BLOCK_N)
+    {
+      unsigned width = jj + GEMM_BLOCK_N < n ? GEMM_BLOCK_N : n - jj;
+      unsigned i = 0;
+      for (; i + 4 <= m; i += 4)
       {
-        setMat(dst, dstTop + i, dstLeft + j, 0);
-        continue;
+        int *restrict c0 = rowMat(matC, i) + jj;
+        int *restrict c1 = rowMat(matC, i + 1) + jj;
+        int *restrict c2 = rowMat(matC, i + 2) + jj;
+        int *restrict c3 = rowMat(matC, i + 3) + jj;
+        const int *a0 = rowMat(matA, i), *a1 = rowMat(matA, i + 1), *a2 = rowMat(matA, i + 2), *a3 = rowMat(matA, i + 3);
+        for (unsigned k = kk; k < kEnd; k++)
+        {
+          const int *restrict b = rowMat(matB, k) + jj;
+          int a0k = a0[k], a1k = a1[k], a2k = a2[k], a3k = a3[k];
+          for (unsigned j = 0; j < width; j++)
+          {
+            c0[j] += a0k * b[j];
+            c1[j] += a1k * b[j];
+            c2[j] += a2k * b[j];
+            c3[j] += a3k * b[j];
+          }
+        }
       }
-
-      // If the destionation matrix is too small, then truncate the source matrix
-      if (dstTop + i >= dst->x || dstLeft + j >= dst->y)
+      // The rows left over
+      for (; i < m; i++)
       {
-        continue;
+        int *restrict c = rowMat(matC, i) + jj;
+        const int *a = rowMat(matA, i);
+        for (unsigned k = kk; k < kEnd; k++)
+        {
+          const int *restrict b = rowMat(matB, k) + jj;
+          for (unsigned j = 0; j < width; j++)
+          {
+            c[j] += a[k] * b[j];
+          }
+        }
       }
-
-      setMat(dst, dstTop + i, dstLeft + j, getMat(src, srcTop + i, srcLeft + j));
     }
   }
 }
 
-//* Negate all elements of a matrix
-void negateMatrix(MAT *src, MAT *dst)
+//* Whether the recursion stops at an m x p by p x n product and uses the classical algorithm.
+// Below the crossover size the recursion costs more than it saves; this also covers the sides of 1, where there is nothing to divide.
+int isStrassenLeaf(unsigned m, unsigned p, unsigned n)
+{
+  unsigned cutoff = strassenCutoff > 0 ? strassenCutoff : 1;
+  return m <= cutoff || p <= cutoff || n <= cutoff;
+}
+
+//* Number of elements of the workspace strassenRecursive() needs for an m x p by p x n product.
+// Every level keeps the seven products and one intermediate for each of A and B, while the level below runs inside the same workspace.
+// The quadrants of A, B and C are views and take no space.
+unsigned long strassenWorkspace(unsigned m, unsigned p, unsigned n)
 {
-  for (unsigned i = 0; i < src->x; i++)
+  if (isStrassenLeaf(m, p, n))
   {
-    for (unsigned j = 0; j < src->y; j++)
-    {
-      setMat(dst, i, j, -getMat(src, i, j));
-    }
+    return 0;
   }
+  unsigned long halfM = m / 2, halfP = p / 2, halfN = n / 2;
+  return 7 * halfM * halfN + halfM * halfP + halfP * halfN + strassenWorkspace(m / 2, p / 2, n / 2);
 }
 
-//* Add two matrices (C = A + B)
-void addMatrix(MAT *matA, MAT *matB, MAT *matC)
+// peelMatrix() and strassenRecursive() for MAT, generated from the template shared with the other element types
+#define T_TYPE MAT
+#define T_ELEM int
+#define T_NAME(name) name
+#define T_ADD(a, b) ((a) + (b))
+#define T_MUL(a, b) ((a) * (b))
+#include "StrassenTemplate.h"
+#undef T_TYPE
+#undef T_ELEM
+#undef T_NAME
+#undef T_ADD
+#undef T_MUL
+
+// Number of elements of the workspace needed by winogradRecursive() for an m x p by p x n product.
+// Every level keeps only two temporaries, because the products are accumulated in the quadrants of C.
+static unsigned long winogradWorkspace(unsigned m, unsigned p, unsigned n)
 {
-  for (unsigned i = 0; i < matA->x; i++)
+  if (isStrassenLeaf(m, p, n))
   {
-    for (unsigned j = 0; j < matA->y; j++)
-    {
-      setMat(matC, i, j, getMat(matA, i, j) + getMat(matB, i, j));
-    }
+    return 0;
   }
+  unsigned long halfM = m / 2, halfP = p / 2, halfN = n / 2;
+  unsigned long widthX = halfP > halfN ? halfP : halfN;
+  return halfM * widthX + halfP * halfN + winogradWorkspace(m / 2, p / 2, n / 2);
 }
 
-//* Calculate the product of two matrices (C = A * B) using Strassen's algorithm
-void Strassen(MAT *matA, MAT *matB, MAT *matC)
+// Winograd's form of Strassen's algorithm on matrices of any shape: 7 products and 15 additions per level.
+// The schedule keeps two temporaries X and Y and uses the quadrants of C for everything else, so C must not overlap A or B.
+static void winogradRecursive(MAT *matA, MAT *matB, MAT *matC, ARENA *arena)
+{
+  unsigned m = matA->x, p = matA->y, n = matB->y;
+
+  /* stop recursive call */
+  if (isStrassenLeaf(m, p, n))
+  {
+    multiplyClassic(matA, matB, matC);
+    return;
+  }
+
+  /* divide */
+  unsigned halfM = m / 2, halfP = p / 2, halfN = n / 2;
+#ifdef STRASSEN_DEBUG
+  printf("[Dimension sizes] m = %d, p = %d, n = %d\n", m, p, n);
+#endif
+
+  MAT matA11 = viewMat(matA, 0, 0, halfM, halfP);
+  MAT matA12 = viewMat(matA, 0, halfP, halfM, halfP);
+  MAT matA21 = viewMat(matA, halfM, 0, halfM, halfP);
+  MAT matA22 = viewMat(matA, halfM, halfP, halfM, halfP);
+
+  MAT matB11 = viewMat(matB, 0, 0, halfP, halfN);
+  MAT matB12 = viewMat(matB, 0, halfN, halfP, halfN);
+  MAT matB21 = viewMat(matB, halfP, 0, halfP, halfN);
+  MAT matB22 = viewMat(matB, halfP, halfN, halfP, halfN);
+
+  MAT matC11 = viewMat(matC, 0, 0, halfM, halfN);
+  MAT matC12 = viewMat(matC, 0, halfN, halfM, halfN);
+  MAT matC21 = viewMat(matC, halfM, 0, halfM, halfN);
+  MAT matC22 = viewMat(matC, halfM, halfN, halfM, halfN);
+
+  /* allocate memory for temporal matrix */
+  // X holds sums of quadrants of A first and A11 B11 later, so it is wide enough for both
+  unsigned long mark = arena->used;
+  MAT matBufferX = allocArena(arena, halfM, halfP > halfN ? halfP : halfN);
+  MAT matX = viewMat(&matBufferX, 0, 0, halfM, halfP);
+  MAT matY = allocArena(arena, halfP, halfN);
+
+  /* conquer and combine */
+  // With S1 = A21 + A22, S2 = S1 - A11, S3 = A11 - A21, S4 = A12 - S2,
+  //      T1 = B12 - B11, T2 = B22 - T1, T3 = B22 - B12, T4 = T2 - B21:
+  // C11 = A11 B11 + A12 B21
+  // C12 = A11 B11 + S2 T2 + S1 T1 + S4 B22
+  // C21 = A11 B11 + S2 T2 + S3 T3 - A22 T4
+  // C22 = A11 B11 + S2 T2 + S3 T3 + S1 T1
+  subMatrix(&matA11, &matA21, &matX);                  // X = S3
+  subMatrix(&matB22, &matB12, &matY);                  // Y = T3
+  winogradRecursive(&matX, &matY, &matC21, arena);     // C21 = S3 T3
+  addMatrix(&matA21, &matA22, &matX);                  // X = S1
+  subMatrix(&matB12, &matB11, &matY);                  // Y = T1
+  winogradRecursive(&matX, &matY, &matC22, arena);     // C22 = S1 T1
+  subMatrix(&matX, &matA11, &matX);                    // X = S2
+  subMatrix(&matB22, &matY, &matY);                    // Y = T2
+  winogradRecursive(&matX, &matY, &matC12, arena);     // C12 = S2 T2
+  subMatrix(&matA12, &matX, &matX);                    // X = S4
+  winogradRecursive(&matX, &matB22, &matC11, arena);   // C11 = S4 B22
+  matX = viewMat(&matBufferX, 0, 0, halfM, halfN);
+  winogradRecursive(&matA11, &matB11, &matX, arena);   // X = A11 B11
+  addMatrix(&matX, &matC12, &matC12);                  // C12 = A11 B11 + S2 T2
+  addMatrix(&matC12, &matC21, &matC21);                // C21 = A11 B11 + S2 T2 + S3 T3
+  addMatrix(&matC12, &matC22, &matC12);                // C12 = A11 B11 + S2 T2 + S1 T1
+  addMatrix(&matC21, &matC22, &matC22);                // C22 is done
+  addMatrix(&matC12, &matC11, &matC12);                // C12 is done
+  subMatrix(&matY, &matB21, &matY);                    // Y = T4
+  winogradRecursive(&matA22, &matY, &matC11, arena);   // C11 = A22 T4
+  subMatrix(&matC21, &matC11, &matC21);                // C21 is done
+  winogradRecursive(&matA12, &matB21, &matC11, arena); // C11 = A12 B21
+  addMatrix(&matX, &matC11, &matC11);                  // C11 is done
+
+  /* release memory for temporal matrix */
+  arena->used = mark;
+
+  /* peel */
+  peelMatrix(matA, matB, matC);
+}
+
+//* Multiply A and B into C with a recursive algorithm, which needs `workspace(m, p, n, ctx)` elements of workspace,
+// and verify the product when verifyRounds is set
+void multiplyRecursive(MAT *matA, MAT *matB, MAT *matC, RECURSIVEFN recursive, WORKSPACEFN workspace, void *ctx)
 {
   // Let m to be the number of rows of matrix A
   unsigned m = matA->x;
@@ -68,255 +212,64 @@ void Strassen(MAT *matA, MAT *matB, MAT *matC)
   }
   // Let n to be the number of columns of matrix B
   unsigned n = matB->y;
-
-  /* stop recursive call */
-  // Simply calculate the product of A and B if the sizes of A and B are small enough
-
-  // If both matrix A and B are both 1x1 matrices, then the product of A and B is a 1x1 matrix
-  if (m == 1 && p == 1 && n == 1)
-  {
-    printf("[Returning early] m = %d, p = %d, n = %d\n", m, p, n);
-    setMat(matC, 0, 0, getMat(matA, 0, 0) * getMat(matB, 0, 0));
-    return;
-  }
-
-  // If both matrix A and B are both 2x2 matrices, then the product of A and B is a 2x2 matrix
-  if (m == 2 && p == 2 && n == 2)
-  {
-    printf("[Returning early] m = %d, p = %d, n = %d\n", m, p, n);
-    setMat(matC, 0, 0, getMat(matA, 0, 0) * getMat(matB, 0, 0) + getMat(matA, 0, 1) * getMat(matB, 1, 0));
-    setMat(matC, 0, 1, getMat(matA, 0, 0) * getMat(matB, 0, 1) + getMat(matA, 0, 1) * getMat(matB, 1, 1));
-    setMat(matC, 1, 0, getMat(matA, 1, 0) * getMat(matB, 0, 0) + getMat(matA, 1, 1) * getMat(matB, 1, 0));
-    setMat(matC, 1, 1, getMat(matA, 1, 0) * getMat(matB, 0, 1) + getMat(matA, 1, 1) * getMat(matB, 1, 1));
-    return;
-  }
-
-  // If m = 1, then the product of A and B is a 1xp matrix
-  if (m == 1)
-  {
-    printf("[Returning early] m = %d, p = %d, n = %d\n", m, p, n);
-    for (unsigned j = 0; j < n; j++)
-    {
-      // C_{1, j} = \sum_{k = 1}^{p} A_{1, k} * B_{k, j}
-      int sum = 0;
-      for (unsigned k = 0; k < p; k++)
-      {
-        sum += getMat(matA, 0, k) * getMat(matB, k, j);
-      }
-      setMat(matC, 0, j, sum);
-    }
-    return;
-  }
-
-  // If n = 1, then the product of A and B is a mx1 matrix
-  if (n == 1)
+  if (matC->x != m || matC->y != n)
   {
-    printf("[Returning early] m = %d, p = %d, n = %d\n", m, p, n);
-    for (unsigned i = 0; i < m; i++)
-    {
-      // C_{i, 1} = \sum_{k = 1}^{p} A_{i, k} * B_{k, 1}
-      int sum = 0;
-      for (unsigned k = 0; k < p; k++)
-      {
-        sum += getMat(matA, i, k) * getMat(matB, k, 0);
-      }
-      setMat(matC, i, 0, sum);
-    }
-    return;
+    printf("Error: Matrix C must have as many rows as matrix A and as many columns as matrix B.\n");
+    exit(1);
   }
 
-  // If p = 1, then the product of A and B is a mxn matrix
-  if (p == 1)
+  /* stop recursive call */
+  if (isStrassenLeaf(m, p, n))
   {
+#ifdef STRASSEN_DEBUG
     printf("[Returning early] m = %d, p = %d, n = %d\n", m, p, n);
-    for (unsigned i = 0; i < m; i++)
-    {
-      for (unsigned j = 0; j < n; j++)
-      {
-        // C_{i, j} = A_{i, 1} * B_{1, j}
-        setMat(matC, i, j, getMat(matA, i, 0) * getMat(matB, 0, j));
-      }
-    }
-    return;
+#endif
+    multiplyClassic(matA, matB, matC);
   }
-
-  /* divide */
-  /* allocate memory for temporal matrix */
-  // Calculate the maximum dimension of the three matrices
-  unsigned max = 2;
-  if (m > max)
-  {
-    max = m;
-  }
-  if (p > max)
-  {
-    max = p;
-  }
-  if (n > max)
-  {
-    max = n;
-  }
-
-  // Calculate the dimension of the padded matrix
-  // the dimension must be minimum one that satisfies the conditions of being power of 2 and being greater or equal to the max
-  unsigned dim = 2;
-  while (dim < max)
+  else
   {
-    dim *= 2;
+    // No padding: every level splits the even part of its matrices and peels off the odd row and columns
+    ARENA *arena = newArena(workspace(m, p, n, ctx));
+    recursive(matA, matB, matC, arena, ctx);
+    freeArena(arena);
   }
+  checkProduct(matA, matB, matC);
+}
 
-  printf("[Dimension sizes] m = %d, p = %d, n = %d, dim = %d\n", m, p, n, dim);
-
-  unsigned halfDim = dim / 2;
-
-  // Calculate the size of the submatrices
-  MAT *matA11 = newMat(halfDim, halfDim);
-  MAT *matA12 = newMat(halfDim, halfDim);
-  MAT *matA21 = newMat(halfDim, halfDim);
-  MAT *matA22 = newMat(halfDim, halfDim);
-
-  MAT *matB11 = newMat(halfDim, halfDim);
-  MAT *matB12 = newMat(halfDim, halfDim);
-  MAT *matB21 = newMat(halfDim, halfDim);
-  MAT *matB22 = newMat(halfDim, halfDim);
-
-  MAT *matP1 = newMat(halfDim, halfDim);
-  MAT *matP2 = newMat(halfDim, halfDim);
-  MAT *matP3 = newMat(halfDim, halfDim);
-  MAT *matP4 = newMat(halfDim, halfDim);
-  MAT *matP5 = newMat(halfDim, halfDim);
-  MAT *matP6 = newMat(halfDim, halfDim);
-  MAT *matP7 = newMat(halfDim, halfDim);
-
-  MAT *matC11 = newMat(halfDim, halfDim);
-  MAT *matC12 = newMat(halfDim, halfDim);
-  MAT *matC21 = newMat(halfDim, halfDim);
-  MAT *matC22 = newMat(halfDim, halfDim);
-
-  // Populate the submatrices
-  copyMatrix(matA, 0, 0, matA11, 0, 0, halfDim, halfDim);
-  copyMatrix(matA, 0, halfDim, matA12, 0, 0, halfDim, halfDim);
-  copyMatrix(matA, halfDim, 0, matA21, 0, 0, halfDim, halfDim);
-  copyMatrix(matA, halfDim, halfDim, matA22, 0, 0, halfDim, halfDim);
-
-  copyMatrix(matB, 0, 0, matB11, 0, 0, halfDim, halfDim);
-  copyMatrix(matB, 0, halfDim, matB12, 0, 0, halfDim, halfDim);
-  copyMatrix(matB, halfDim, 0, matB21, 0, 0, halfDim, halfDim);
-  copyMatrix(matB, halfDim, halfDim, matB22, 0, 0, halfDim, halfDim);
-
-  /* conquer */
-  // Calculate the submatrices
-
-  // Calculate P1 = (A11 + A22) * (B11 + B22)
-  MAT *matP1Intm1 = newMat(halfDim, halfDim);
-  MAT *matP1Intm2 = newMat(halfDim, halfDim);
-  addMatrix(matA11, matA22, matP1Intm1);
-  addMatrix(matB11, matB22, matP1Intm2);
-  Strassen(matP1Intm1, matP1Intm2, matP1);
-  free(matP1Intm1);
-  free(matP1Intm2);
-
-  // Calculate P2 = (A21 + A22) * B11
-  MAT *matP2Intm1 = newMat(halfDim, halfDim);
-  addMatrix(matA21, matA22, matP2Intm1);
-  Strassen(matP2Intm1, matB11, matP2);
-  free(matP2Intm1);
-
-  // Calculate P3 = A11 * (B12 - B22)
-  MAT *matP3Intm1 = newMat(halfDim, halfDim);
-  MAT *matP3Intm2 = newMat(halfDim, halfDim);
-  negateMatrix(matB22, matP3Intm1);
-  addMatrix(matB12, matP3Intm1, matP3Intm2);
-  Strassen(matA11, matP3Intm2, matP3);
-  free(matP3Intm1);
-  free(matP3Intm2);
-
-  // Calculate P4 = A22 * (B21 - B11)
-  MAT *matP4Intm1 = newMat(halfDim, halfDim);
-  MAT *matP4Intm2 = newMat(halfDim, halfDim);
-  negateMatrix(matB11, matP4Intm1);
-  addMatrix(matB21, matP4Intm1, matP4Intm2);
-  Strassen(matA22, matP4Intm2, matP4);
-  free(matP4Intm1);
-  free(matP4Intm2);
-
-  // Calculate P5 = (A11 + A12) * B22
-  MAT *matP5Intm1 = newMat(halfDim, halfDim);
-  addMatrix(matA11, matA12, matP5Intm1);
-  Strassen(matP5Intm1, matB22, matP5);
-  free(matP5Intm1);
-
-  // Calculate P6 = (A21 - A11) * (B11 + B12)
-  MAT *matP6Intm1 = newMat(halfDim, halfDim);
-  MAT *matP6Intm2 = newMat(halfDim, halfDim);
-  MAT *matP6Intm3 = newMat(halfDim, halfDim);
-  negateMatrix(matA11, matP6Intm1);
-  addMatrix(matA21, matP6Intm1, matP6Intm2);
-  addMatrix(matB11, matB12, matP6Intm3);
-  Strassen(matP6Intm2, matP6Intm3, matP6);
-  free(matP6Intm1);
-  free(matP6Intm2);
-  free(matP6Intm3);
-
-  // Calculate P7 = (A12 - A22) * (B21 + B22)
-  MAT *matP7Intm1 = newMat(halfDim, halfDim);
-  MAT *matP7Intm2 = newMat(halfDim, halfDim);
-  MAT *matP7Intm3 = newMat(halfDim, halfDim);
-  negateMatrix(matA22, matP7Intm1);
-  addMatrix(matA12, matP7Intm1, matP7Intm2);
-  addMatrix(matB21, matB22, matP7Intm3);
-  Strassen(matP7Intm2, matP7Intm3, matP7);
-
-  /* combine */
-  // Calculate C11 = P1 + P4 - P5 + P7
-  MAT *matC11IntmNegatedP5 = newMat(halfDim, halfDim);
-  negateMatrix(matP5, matC11IntmNegatedP5);
-  addMatrix(matP1, matP4, matC11);
-  addMatrix(matC11, matC11IntmNegatedP5, matC11);
-  addMatrix(matC11, matP7, matC11);
-  free(matC11IntmNegatedP5);
-
-  // Calculate C12 = P3 + P5
-  addMatrix(matP3, matP5, matC12);
-
-  // Calculate C21 = P2 + P4
-  addMatrix(matP2, matP4, matC21);
-
-  // Calculate C22 = P1 - P2 + P3 + P6
-  MAT *matC22IntmNegatedP2 = newMat(halfDim, halfDim);
-  negateMatrix(matP2, matC22IntmNegatedP2);
-  addMatrix(matP1, matC22IntmNegatedP2, matC22);
-  addMatrix(matC22, matP3, matC22);
-  addMatrix(matC22, matP6, matC22);
-  free(matC22IntmNegatedP2);
+// Adapters from the sequential algorithms to RECURSIVEFN and WORKSPACEFN, which need no context
+static void strassenTop(MAT *matA, MAT *matB, MAT *matC, ARENA *arena, void *ctx)
+{
+  (void)ctx;
+  strassenRecursive(matA, matB, matC, arena);
+}
 
-  // Copy the submatrices back to the original matrix
-  copyMatrix(matC11, 0, 0, matC, 0, 0, halfDim, halfDim);
-  copyMatrix(matC12, 0, 0, matC, 0, halfDim, halfDim, halfDim);
-  copyMatrix(matC21, 0, 0, matC, halfDim, 0, halfDim, halfDim);
-  copyMatrix(matC22, 0, 0, matC, halfDim, halfDim, halfDim, halfDim);
+static unsigned long strassenTopWorkspace(unsigned m, unsigned p, unsigned n, void *ctx)
+{
+  (void)ctx;
+  return strassenWorkspace(m, p, n);
+}
 
-  /* release memory for temporal matrix */
-  free(matA11);
-  free(matA12);
-  free(matA21);
-  free(matA22);
+static void winogradTop(MAT *matA, MAT *matB, MAT *matC, ARENA *arena, void *ctx)
+{
+  (void)ctx;
+  winogradRecursive(matA, matB, matC, arena);
+}
 
-  free(matB11);
-  free(matB12);
-  free(matB21);
-  free(matB22);
+static unsigned long winogradTopWorkspace(unsigned m, unsigned p, unsigned n, void *ctx)
+{
+  (void)ctx;
+  return winogradWorkspace(m, p, n);
+}
 
-  free(matP1);
-  free(matP2);
-  free(matP3);
-  free(matP4);
-  free(matP5);
-  free(matP6);
-  free(matP7);
+//* Calculate the product of two matrices (C = A * B) using Strassen's algorithm
+void Strassen(MAT *matA, MAT *matB, MAT *matC)
+{
+  multiplyRecursive(matA, matB, matC, strassenTop, strassenTopWorkspace, NULL);
+}
 
-  free(matC11);
-  free(matC12);
-  free(matC21);
-  free(matC22);
+//* Calculate the product of two matrices (C = A * B) using the Winograd variant of Strassen's algorithm.
+// It needs 15 additions per level instead of 18, and two temporaries instead of nine.
+void Winograd(MAT *matA, MAT *matB, MAT *matC)
+{
+  multiplyRecursive(matA, matB, matC, winogradTop, winogradTopWorkspace, NULL);
 }
@@ -1 +1,31 @@
+// Default crossover size, used until tuneStrassenCutoff() or loadStrassenCutoff() sets another one
+#define STRASSEN_CUTOFF 64
+// Blocking of the classical kernel: a GEMM_BLOCK_K x GEMM_BLOCK_N block of B (128 KiB) stays in L2 cache
+#define GEMM_BLOCK_K 128
+#define GEMM_BLOCK_N 256
+
+extern unsigned strassenCutoff;
+
 void Strassen(MAT *matA, MAT *matB, MAT *matC);
+void Winograd(MAT *matA, MAT *matB, MAT *matC);
+void multiplyClassic(MAT *matA, MAT *matB, MAT *matC);
+
+// Threads spawn tasks for the levels of the recursion until there are about this many tasks per thread
+#define STRASSEN_TASKS_PER_THREAD 4
+
+void StrassenParallel(MAT *matA, MAT *matB, MAT *matC, unsigned threads);
+
+// Building blocks of the recursive algorithms, shared with the parallel mode in Parallel.c.
+// A RECURSIVEFN multiplies matrices of any shape, taking its temporaries from `arena`;
+// the matching WORKSPACEFN gives the number of elements of workspace it needs for an m x p by p x n product.
+typedef void (*RECURSIVEFN)(MAT *matA, MAT *matB, MAT *matC, ARENA *arena, void *ctx);
+typedef unsigned long (*WORKSPACEFN)(unsigned m, unsigned p, unsigned n, void *ctx);
+void multiplyRecursive(MAT *matA, MAT *matB, MAT *matC, RECURSIVEFN recursive, WORKSPACEFN workspace, void *ctx);
+int isStrassenLeaf(unsigned m, unsigned p, unsigned n);
+void peelMatrix(MAT *matA, MAT *matB, MAT *matC);
+void strassenRecursive(MAT *matA, MAT *matB, MAT *matC, ARENA *arena);
+unsigned long strassenWorkspace(unsigned m, unsigned p, unsigned n);
+
+unsigned tuneStrassenCutoff(unsigned size);
+int saveStrassenCutoff(const char *path);
+int loadStrassenCutoff(const char *path);
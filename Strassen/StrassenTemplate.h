@@ -0,0 +1,166 @@
+// Strassen's algorithm with dynamic peeling for one matrix type, included by Strassen.c for MAT and by TypedTemplate.h for the others.
+// The including file defines T_TYPE, T_ELEM, T_ADD, T_MUL and T_NAME(name) as TypedTemplate.h does, and before the inclusion
+//   T_NAME(ARENA), T_NAME(allocArena)         a workspace handed out like a stack, as ARENA
+//   T_NAME(rowMat), T_NAME(checkBlockMat)     the bulk accessors, as rowMat() and checkBlockMat()
+//   T_NAME(viewMat), T_NAME(addMatrix), T_NAME(subMatrix), T_NAME(combineMatrix), T_NAME(multiplyClassic)
+
+//* Dynamic peeling: complete C = A * B once C[0:m', 0:n'] holds A[0:m', 0:p'] * B[0:p', 0:n'],
+// where m', p' and n' are m, p and n rounded down to even numbers.
+// An odd p adds a rank-1 update to that block, an odd n fills the last column and an odd m the last row.
+void T_NAME(peelMatrix)(T_TYPE *matA, T_TYPE *matB, T_TYPE *matC)
+{
+  unsigned m = matA->x, p = matA->y, n = matB->y;
+  unsigned evenM = m & ~1u, evenP = p & ~1u, evenN = n & ~1u;
+  T_NAME(checkBlockMat)(matB, 0, 0, p, n);
+  T_NAME(checkBlockMat)(matC, 0, 0, m, n);
+
+  // C[0:m', 0:n'] += A[0:m', p - 1] B[p - 1, 0:n']
+  if (p != evenP)
+  {
+    const T_ELEM *b = T_NAME(rowMat)(matB, evenP);
+    for (unsigned i = 0; i < evenM; i++)
+    {
+      T_ELEM a = T_NAME(rowMat)(matA, i)[evenP];
+      T_ELEM *c = T_NAME(rowMat)(matC, i);
+      for (unsigned j = 0; j < evenN; j++)
+      {
+        c[j] = T_ADD(c[j], T_MUL(a, b[j]));
+      }
+    }
+  }
+
+  // C[0:m, n - 1] = A B[0:p, n - 1]
+  if (n != evenN)
+  {
+    for (unsigned i = 0; i < m; i++)
+    {
+      const T_ELEM *a = T_NAME(rowMat)(matA, i);
+      T_ELEM sum = 0;
+      for (unsigned k = 0; k < p; k++)
+      {
+        sum = T_ADD(sum, T_MUL(a[k], T_NAME(rowMat)(matB, k)[evenN]));
+      }
+      T_NAME(rowMat)(matC, i)[evenN] = sum;
+    }
+  }
+
+  // C[m - 1, 0:n'] = A[m - 1, 0:p] B[0:p, 0:n'], accumulated row by row of B
+  if (m != evenM)
+  {
+    const T_ELEM *a = T_NAME(rowMat)(matA, evenM);
+    T_ELEM *c = T_NAME(rowMat)(matC, evenM);
+    for (unsigned j = 0; j < evenN; j++)
+    {
+      c[j] = 0;
+    }
+    for (unsigned k = 0; k < p; k++)
+    {
+      const T_ELEM *b = T_NAME(rowMat)(matB, k);
+      for (unsigned j = 0; j < evenN; j++)
+      {
+        c[j] = T_ADD(c[j], T_MUL(a[k], b[j]));
+      }
+    }
+  }
+}
+
+//* Strassen's algorithm on matrices of any shape, with every temporary matrix taken from `arena`,
+// which must hold strassenWorkspace(m, p, n) elements.
+// The leading even part is split into quadrants, which are views addressed in place, and the odd row and columns are peeled off.
+void T_NAME(strassenRecursive)(T_TYPE *matA, T_TYPE *matB, T_TYPE *matC, T_NAME(ARENA) *arena)
+{
+  unsigned m = matA->x, p = matA->y, n = matB->y;
+
+  /* stop recursive call */
+  if (isStrassenLeaf(m, p, n))
+  {
+    T_NAME(multiplyClassic)(matA, matB, matC);
+    return;
+  }
+
+  /* divide */
+  unsigned halfM = m / 2, halfP = p / 2, halfN = n / 2;
+#ifdef STRASSEN_DEBUG
+  printf("[Dimension sizes] m = %d, p = %d, n = %d\n", m, p, n);
+#endif
+
+  T_TYPE matA11 = T_NAME(viewMat)(matA, 0, 0, halfM, halfP);
+  T_TYPE matA12 = T_NAME(viewMat)(matA, 0, halfP, halfM, halfP);
+  T_TYPE matA21 = T_NAME(viewMat)(matA, halfM, 0, halfM, halfP);
+  T_TYPE matA22 = T_NAME(viewMat)(matA, halfM, halfP, halfM, halfP);
+
+  T_TYPE matB11 = T_NAME(viewMat)(matB, 0, 0, halfP, halfN);
+  T_TYPE matB12 = T_NAME(viewMat)(matB, 0, halfN, halfP, halfN);
+  T_TYPE matB21 = T_NAME(viewMat)(matB, halfP, 0, halfP, halfN);
+  T_TYPE matB22 = T_NAME(viewMat)(matB, halfP, halfN, halfP, halfN);
+
+  T_TYPE matC11 = T_NAME(viewMat)(matC, 0, 0, halfM, halfN);
+  T_TYPE matC12 = T_NAME(viewMat)(matC, 0, halfN, halfM, halfN);
+  T_TYPE matC21 = T_NAME(viewMat)(matC, halfM, 0, halfM, halfN);
+  T_TYPE matC22 = T_NAME(viewMat)(matC, halfM, halfN, halfM, halfN);
+
+  /* allocate memory for temporal matrix */
+  unsigned long mark = arena->used;
+  T_TYPE matP1 = T_NAME(allocArena)(arena, halfM, halfN);
+  T_TYPE matP2 = T_NAME(allocArena)(arena, halfM, halfN);
+  T_TYPE matP3 = T_NAME(allocArena)(arena, halfM, halfN);
+  T_TYPE matP4 = T_NAME(allocArena)(arena, halfM, halfN);
+  T_TYPE matP5 = T_NAME(allocArena)(arena, halfM, halfN);
+  T_TYPE matP6 = T_NAME(allocArena)(arena, halfM, halfN);
+  T_TYPE matP7 = T_NAME(allocArena)(arena, halfM, halfN);
+  // Intermediates shared by all products, shaped like the quadrants of A and of B
+  T_TYPE matIntmA = T_NAME(allocArena)(arena, halfM, halfP);
+  T_TYPE matIntmB = T_NAME(allocArena)(arena, halfP, halfN);
+
+  /* conquer */
+  // Calculate P1 = (A11 + A22) * (B11 + B22)
+  T_NAME(addMatrix)(&matA11, &matA22, &matIntmA);
+  T_NAME(addMatrix)(&matB11, &matB22, &matIntmB);
+  T_NAME(strassenRecursive)(&matIntmA, &matIntmB, &matP1, arena);
+
+  // Calculate P2 = (A21 + A22) * B11
+  T_NAME(addMatrix)(&matA21, &matA22, &matIntmA);
+  T_NAME(strassenRecursive)(&matIntmA, &matB11, &matP2, arena);
+
+  // Calculate P3 = A11 * (B12 - B22)
+  T_NAME(subMatrix)(&matB12, &matB22, &matIntmB);
+  T_NAME(strassenRecursive)(&matA11, &matIntmB, &matP3, arena);
+
+  // Calculate P4 = A22 * (B21 - B11)
+  T_NAME(subMatrix)(&matB21, &matB11, &matIntmB);
+  T_NAME(strassenRecursive)(&matA22, &matIntmB, &matP4, arena);
+
+  // Calculate P5 = (A11 + A12) * B22
+  T_NAME(addMatrix)(&matA11, &matA12, &matIntmA);
+  T_NAME(strassenRecursive)(&matIntmA, &matB22, &matP5, arena);
+
+  // Calculate P6 = (A21 - A11) * (B11 + B12)
+  T_NAME(subMatrix)(&matA21, &matA11, &matIntmA);
+  T_NAME(addMatrix)(&matB11, &matB12, &matIntmB);
+  T_NAME(strassenRecursive)(&matIntmA, &matIntmB, &matP6, arena);
+
+  // Calculate P7 = (A12 - A22) * (B21 + B22)
+  T_NAME(subMatrix)(&matA12, &matA22, &matIntmA);
+  T_NAME(addMatrix)(&matB21, &matB22, &matIntmB);
+  T_NAME(strassenRecursive)(&matIntmA, &matIntmB, &matP7, arena);
+
+  /* combine */
+  // The quadrants of C are written in place
+  // Calculate C11 = P1 + P4 - P5 + P7
+  T_NAME(combineMatrix)(&matP1, &matP4, &matP5, &matP7, &matC11);
+
+  // Calculate C12 = P3 + P5
+  T_NAME(addMatrix)(&matP3, &matP5, &matC12);
+
+  // Calculate C21 = P2 + P4
+  T_NAME(addMatrix)(&matP2, &matP4, &matC21);
+
+  // Calculate C22 = P1 - P2 + P3 + P6
+  T_NAME(combineMatrix)(&matP1, &matP3, &matP2, &matP6, &matC22);
+
+  /* release memory for temporal matrix */
+  arena->used = mark;
+
+  /* peel */
+  T_NAME(peelMatrix)(matA, matB, matC);
+}
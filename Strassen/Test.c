@@ -1,11 +1,64 @@
 # include <stdlib.h>
 # include <stdio.h>
+# include <string.h>
 # include "Matrix.h"
 # include "Strassen.h"
+# include "MatFile.h"
+# include "Morton.h"
+# include "Verify.h"
+
+/* crossover size measured by "-tune" */
+# define STRASSEN_CONFIG "strassen.conf"
 
 extern MAT data1, data2;
 
-int main() {
+/* Strassen's algorithm on one thread per online core */
+static void multiplyParallel(MAT *matA, MAT *matB, MAT *matC) {
+	StrassenParallel(matA, matB, matC, 0);
+}
+
+int main(int argc, char *argv[]) {
+	if ( argc > 1 && strcmp(argv[1], "-tune") == 0 ) {
+		printf("cutoff = %u\n", tuneStrassenCutoff(argc > 2 ? atoi(argv[2]) : 1024));
+		if ( saveStrassenCutoff(STRASSEN_CONFIG) != 0 ) perror(STRASSEN_CONFIG);
+		return 0;
+	}
+	loadStrassenCutoff(STRASSEN_CONFIG);
+	/* options, in any order before the other arguments */
+	int arg = 1;
+	void (*multiply)(MAT *, MAT *, MAT *) = Strassen;
+	for ( ; arg < argc; arg ++ ) {
+		/* "-winograd" selects the Winograd variant, "-parallel" the parallel mode, "-tiled" the tiled layout */
+		if ( strcmp(argv[arg], "-winograd") == 0 ) multiply = Winograd;
+		else if ( strcmp(argv[arg], "-parallel") == 0 ) multiply = multiplyParallel;
+		else if ( strcmp(argv[arg], "-tiled") == 0 ) multiply = StrassenTiled;
+		/* "-verify" checks every product with Freivalds' algorithm */
+		else if ( strcmp(argv[arg], "-verify") == 0 ) verifyRounds = VERIFY_ROUNDS;
+		else break;
+	}
+
+	/* "-export A B" writes the built-in matrices to matrix files */
+	if ( arg + 2 < argc && strcmp(argv[arg], "-export") == 0 ) {
+		if ( saveMat(&data1, argv[arg + 1]) != 0 ) perror(argv[arg + 1]);
+		if ( saveMat(&data2, argv[arg + 2]) != 0 ) perror(argv[arg + 2]);
+		return 0;
+	}
+
+	/* "A B C" multiplies the matrix files A and B into the matrix file C */
+	if ( arg + 3 == argc ) {
+		MATFILE *fileA = openMatFile(argv[arg]);
+		if ( fileA == NULL ) { perror(argv[arg]); return 1; }
+		MATFILE *fileB = openMatFile(argv[arg + 1]);
+		if ( fileB == NULL ) { perror(argv[arg + 1]); return 1; }
+		MATFILE *fileC = createMatFile(argv[arg + 2], fileA->mat.x, fileB->mat.y);
+		if ( fileC == NULL ) { perror(argv[arg + 2]); return 1; }
+		multiply(&fileA->mat, &fileB->mat, &fileC->mat);
+		closeMatFile(fileA);
+		closeMatFile(fileB);
+		closeMatFile(fileC);
+		return 0;
+	}
+
 	MAT *matA = &data1;
 	MAT *matB = &data2;
 	MAT *matC = newMat(matA->x, matB->y);
@@ -13,6 +66,6 @@ int main() {
 	puts("multiplied by");
 	printMat(matB);
 	puts("equals");
-	Strassen(matA, matB, matC);
+	multiply(matA, matB, matC);
 	printMat(matC);
 }
@@ -0,0 +1,174 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include "Matrix.h"
+#include "Strassen.h"
+#include "Typed.h"
+
+static void errorTyped(char *str)
+{
+  perror(str);
+  exit(EXIT_FAILURE);
+}
+
+#define T_PASTE2(name, suffix) name##suffix
+#define T_PASTE(name, suffix) T_PASTE2(name, suffix)
+#define T_NAME(name) T_PASTE(name, T_S)
+
+/* long long */
+#define T_TYPE MAT64
+#define T_ELEM long long
+#define T_S 64
+#define T_FORMAT "%lld"
+#define T_ADD(a, b) ((a) + (b))
+#define T_SUB(a, b) ((a) - (b))
+#define T_MUL(a, b) ((a) * (b))
+#define T_NORMALIZE(x) (x)
+#define T_BLOCK_K GEMM_BLOCK_K_64
+#define T_BLOCK_N GEMM_BLOCK_N_64
+#include "TypedTemplate.h"
+#undef T_TYPE
+#undef T_ELEM
+#undef T_S
+#undef T_FORMAT
+#undef T_BLOCK_K
+#undef T_BLOCK_N
+
+/* float */
+#define T_TYPE MATF
+#define T_ELEM float
+#define T_S F
+#define T_FORMAT "%g"
+#define T_BLOCK_K GEMM_BLOCK_K_F
+#define T_BLOCK_N GEMM_BLOCK_N_F
+#include "TypedTemplate.h"
+#undef T_TYPE
+#undef T_ELEM
+#undef T_S
+#undef T_FORMAT
+#undef T_BLOCK_K
+#undef T_BLOCK_N
+
+/* double */
+#define T_TYPE MATD
+#define T_ELEM double
+#define T_S D
+#define T_FORMAT "%g"
+#define T_BLOCK_K GEMM_BLOCK_K_D
+#define T_BLOCK_N GEMM_BLOCK_N_D
+#include "TypedTemplate.h"
+#undef T_TYPE
+#undef T_ELEM
+#undef T_S
+#undef T_FORMAT
+#undef T_BLOCK_K
+#undef T_BLOCK_N
+#undef T_ADD
+#undef T_SUB
+#undef T_MUL
+#undef T_NORMALIZE
+
+/* integers modulo p */
+// Barrett reduction: with mu = floor((2^64 - 1) / p), the quotient estimate floor(x mu / 2^64) is at most 2 below x / p.
+// p is below 2^31, so that the sum of two residues fits in 32 bits.
+static uint32_t modulus = DEFAULT_MODULUS;
+static uint64_t modulusMu = UINT64_MAX / DEFAULT_MODULUS;
+// 2^32 modulo p, the weight of the high halves of the products
+static uint64_t modulusHigh = (1ull << 32) % DEFAULT_MODULUS;
+
+//* Set the modulus of MATMOD, which must be at least 2 and below 2^31. Matrices keep the residues they hold.
+void setModulus(uint32_t p)
+{
+  if (p < 2 || p >= 1u << 31)
+  {
+    fprintf(stderr, "setModulus: %u is out of range\n", p);
+    exit(EXIT_FAILURE);
+  }
+  modulus = p;
+  modulusMu = UINT64_MAX / p;
+  modulusHigh = (1ull << 32) % p;
+}
+
+uint32_t getModulus(void)
+{
+  return modulus;
+}
+
+static inline uint32_t reduceMod(uint64_t x)
+{
+  uint64_t q = (uint64_t)(((unsigned __int128)x * modulusMu) >> 64);
+  uint64_t r = x - q * modulus;
+  while (r >= modulus)
+  {
+    r -= modulus;
+  }
+  return (uint32_t)r;
+}
+
+static inline uint32_t addMod(uint32_t a, uint32_t b)
+{
+  uint32_t s = a + b;
+  return s >= modulus ? s - modulus : s;
+}
+
+static inline uint32_t subMod(uint32_t a, uint32_t b)
+{
+  return a >= b ? a - b : a + modulus - b;
+}
+
+#define T_TYPE MATMOD
+#define T_ELEM uint32_t
+#define T_S Mod
+#define T_FORMAT "%u"
+#define T_ADD(a, b) addMod((a), (b))
+#define T_SUB(a, b) subMod((a), (b))
+// The peeling in StrassenTemplate.h reduces after every product; it does O((m + n) p) of them per level, against the O(m p n) of the kernel
+#define T_MUL(a, b) reduceMod((uint64_t)(a) * (b))
+#define T_NORMALIZE(x) ((x) % modulus)
+#include "TypedTemplate.h"
+
+//* Calculate the product of two matrices modulo p (C = A * B) with the classical algorithm.
+// The products of two residues, below 2^62, are split into 32-bit halves which are summed apart: with fewer than 2^32 terms
+// neither sum can overflow 64 bits, so the inner loop is a multiply-add on each half and vectorizes like that of multiplyClassic().
+// Each element of C is reduced only once, as high * (2^32 mod p) + low, when it is stored.
+void multiplyClassicMod(MATMOD *matA, MATMOD *matB, MATMOD *matC)
+{
+  unsigned m = matA->x;
+  unsigned p = matA->y;
+  unsigned n = matB->y;
+  uint64_t low[GEMM_BLOCK_N_MOD];
+  uint64_t high[GEMM_BLOCK_N_MOD];
+  checkProductShapeMod(matA, matB, matC);
+  checkBlockMatMod(matB, 0, 0, p, n);
+  checkBlockMatMod(matC, 0, 0, m, n);
+
+  for (unsigned jj = 0; jj < n; jj += GEMM_BLOCK_N_MOD)
+  {
+    unsigned width = jj + GEMM_BLOCK_N_MOD < n ? GEMM_BLOCK_N_MOD : n - jj;
+    for (unsigned i = 0; i < m; i++)
+    {
+      const uint32_t *a = rowMatMod(matA, i);
+      for (unsigned j = 0; j < width; j++)
+      {
+        low[j] = 0;
+        high[j] = 0;
+      }
+      for (unsigned k = 0; k < p; k++)
+      {
+        const uint32_t *restrict b = rowMatMod(matB, k) + jj;
+        uint64_t ak = a[k];
+        for (unsigned j = 0; j < width; j++)
+        {
+          uint64_t product = ak * b[j];
+          low[j] += (uint32_t)product;
+          high[j] += product >> 32;
+        }
+      }
+      uint32_t *c = rowMatMod(matC, i) + jj;
+      for (unsigned j = 0; j < width; j++)
+      {
+        c[j] = reduceMod(reduceMod(high[j]) * modulusHigh + reduceMod(low[j]));
+      }
+    }
+  }
+}
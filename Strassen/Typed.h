@@ -0,0 +1,44 @@
+#include <stdint.h>
+
+// Matrices of other element types than int, generated from TypedTemplate.h by Typed.c.
+// TYPE is laid out like MAT, and its functions are those of MAT with the suffix S: newMat64, StrassenF, ...
+#define DECLARE_TYPED_MATRIX(TYPE, S, ELEM)                                                \
+  typedef struct                                                                           \
+  {                                                                                        \
+    unsigned x;                                                                            \
+    unsigned y;                                                                            \
+    ELEM *v;                                                                               \
+    unsigned stride;                                                                       \
+  } TYPE;                                                                                  \
+  TYPE *newMat##S(unsigned sizeX, unsigned sizeY);                                         \
+  void freeMat##S(TYPE *mat);                                                              \
+  TYPE viewMat##S(TYPE *mat, unsigned top, unsigned left, unsigned sizeX, unsigned sizeY); \
+  ELEM getMat##S(TYPE *mat, unsigned x, unsigned y);                                       \
+  void setMat##S(TYPE *mat, unsigned x, unsigned y, ELEM val);                             \
+  void printMat##S(TYPE *mat);                                                             \
+  void addMatrix##S(TYPE *matA, TYPE *matB, TYPE *matC);                                   \
+  void subMatrix##S(TYPE *matA, TYPE *matB, TYPE *matC);                                   \
+  void multiplyClassic##S(TYPE *matA, TYPE *matB, TYPE *matC);                             \
+  void Strassen##S(TYPE *matA, TYPE *matB, TYPE *matC);
+
+DECLARE_TYPED_MATRIX(MAT64, 64, long long)
+DECLARE_TYPED_MATRIX(MATF, F, float)
+DECLARE_TYPED_MATRIX(MATD, D, double)
+// Integers modulo the prime set by setModulus(), stored as residues 0, 1, ..., p - 1
+DECLARE_TYPED_MATRIX(MATMOD, Mod, uint32_t)
+
+// Blocking of the classical kernels, in elements: a block of B stays in L2 cache as for GEMM_BLOCK_K x GEMM_BLOCK_N
+#define GEMM_BLOCK_K_64 128
+#define GEMM_BLOCK_N_64 128
+#define GEMM_BLOCK_K_F 128
+#define GEMM_BLOCK_N_F 256
+#define GEMM_BLOCK_K_D 128
+#define GEMM_BLOCK_N_D 128
+// The modular kernel accumulates 64-bit sums of a block of at most this many columns of C in registers and on the stack
+#define GEMM_BLOCK_N_MOD 256
+
+// Default modulus of MATMOD, the prime 2^31 - 1
+#define DEFAULT_MODULUS 2147483647u
+
+void setModulus(uint32_t p);
+uint32_t getModulus(void);
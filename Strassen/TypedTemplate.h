@@ -0,0 +1,304 @@
+// Matrix functions and Strassen's algorithm for one element type, included by Typed.c once per type.
+// The including file defines
+//   T_TYPE, T_ELEM, T_S      the matrix type, its element type and the suffix of the function names
+//   T_FORMAT                 printf format of an element
+//   T_ADD, T_SUB, T_MUL      arithmetic on elements
+//   T_NORMALIZE              the element stored by setMat (e.g. reduced modulo p)
+//   T_BLOCK_K, T_BLOCK_N     blocking of the classical kernel; without them, the including file defines multiplyClassic
+// and T_NAME(name), which appends the suffix to a name.
+// Strassen's algorithm itself is StrassenTemplate.h, shared with MAT.
+
+T_TYPE *T_NAME(newMat)(unsigned sizeX, unsigned sizeY)
+{
+  T_TYPE *new;
+  if ((new = (T_TYPE *)malloc(sizeof(T_TYPE))) == NULL)
+    errorTyped("newMat: no more memory");
+  new->x = sizeX;
+  new->y = sizeY;
+  new->stride = sizeY;
+  if ((new->v = (T_ELEM *)calloc((unsigned long)sizeX * sizeY, sizeof(T_ELEM))) == NULL)
+    errorTyped("newMat: too large");
+  return new;
+}
+
+void T_NAME(freeMat)(T_TYPE *mat)
+{
+  free(mat->v);
+  free(mat);
+}
+
+T_TYPE T_NAME(viewMat)(T_TYPE *mat, unsigned top, unsigned left, unsigned sizeX, unsigned sizeY)
+{
+  T_TYPE view;
+  if (top + sizeX > mat->x)
+    errorTyped("viewMat: x is out of range");
+  if (left + sizeY > mat->y)
+    errorTyped("viewMat: y is out of range");
+  view.x = sizeX;
+  view.y = sizeY;
+  view.v = mat->v + (unsigned long)top * mat->stride + left;
+  view.stride = mat->stride;
+  return view;
+}
+
+T_ELEM T_NAME(getMat)(T_TYPE *mat, unsigned x, unsigned y)
+{
+#if MAT_CHECKED
+  if (x >= mat->x)
+    errorTyped("getMat: x is out of range");
+  if (y >= mat->y)
+    errorTyped("getMat: y is out of range");
+#endif
+  return mat->v[(unsigned long)x * mat->stride + y];
+}
+
+void T_NAME(setMat)(T_TYPE *mat, unsigned x, unsigned y, T_ELEM val)
+{
+#if MAT_CHECKED
+  if (x >= mat->x)
+    errorTyped("setMat: x is out of range");
+  if (y >= mat->y)
+    errorTyped("setMat: y is out of range");
+#endif
+  mat->v[(unsigned long)x * mat->stride + y] = T_NORMALIZE(val);
+}
+
+// Pointer to the first element of row x, as rowMat()
+static inline T_ELEM *T_NAME(rowMat)(T_TYPE *mat, unsigned x)
+{
+#if MAT_CHECKED
+  if (x >= mat->x)
+    rangeErrorMat("rowMat: x is out of range");
+#endif
+  return mat->v + (unsigned long)x * mat->stride;
+}
+
+// Check that the rows x cols block at (top, left) lies inside the matrix, as checkBlockMat()
+static inline void T_NAME(checkBlockMat)(T_TYPE *mat, unsigned top, unsigned left, unsigned rows, unsigned cols)
+{
+#if MAT_CHECKED
+  if (top + rows > mat->x || left + cols > mat->y)
+    rangeErrorMat("checkBlockMat: the block is out of range");
+#else
+  (void)mat, (void)top, (void)left, (void)rows, (void)cols;
+#endif
+}
+
+// Workspace for temporary matrices, handed out like a stack as an ARENA is
+typedef struct
+{
+  T_ELEM *base;
+  unsigned long size;
+  unsigned long used;
+} T_NAME(ARENA);
+
+static T_NAME(ARENA) *T_NAME(newArena)(unsigned long size)
+{
+  T_NAME(ARENA) *new;
+  if ((new = (T_NAME(ARENA) *)malloc(sizeof(T_NAME(ARENA)))) == NULL)
+    errorTyped("newArena: no more memory");
+  new->size = size;
+  new->used = 0;
+  if ((new->base = (T_ELEM *)malloc((size > 0 ? size : 1) * sizeof(T_ELEM))) == NULL)
+    errorTyped("newArena: too large");
+  return new;
+}
+
+static void T_NAME(freeArena)(T_NAME(ARENA) *arena)
+{
+  free(arena->base);
+  free(arena);
+}
+
+// The elements are not initialised
+static T_TYPE T_NAME(allocArena)(T_NAME(ARENA) *arena, unsigned sizeX, unsigned sizeY)
+{
+  T_TYPE mat;
+  unsigned long need = (unsigned long)sizeX * sizeY;
+  if (arena->used + need > arena->size)
+  {
+    fprintf(stderr, "allocArena: the workspace is exhausted\n");
+    exit(EXIT_FAILURE);
+  }
+  mat.x = sizeX;
+  mat.y = sizeY;
+  mat.v = arena->base + arena->used;
+  mat.stride = sizeY;
+  arena->used += need;
+  return mat;
+}
+
+void T_NAME(printMat)(T_TYPE *mat)
+{
+  for (unsigned x = 0; x < mat->x; x++)
+  {
+    for (unsigned y = 0; y < mat->y; y++)
+    {
+      printf(" " T_FORMAT, T_NAME(getMat)(mat, x, y));
+    }
+    putchar('\n');
+  }
+}
+
+// Check that two matrices have the same shape, as checkShape() in Kernel.c
+static void T_NAME(checkShape)(T_TYPE *mat, T_TYPE *dst)
+{
+  if (mat->x != dst->x || mat->y != dst->y)
+  {
+    printf("Error: The matrices must have the same number of rows and columns.\n");
+    exit(1);
+  }
+}
+
+// Check that C = A * B is defined: A has as many columns as B has rows, and C is as tall as A and as wide as B
+static void T_NAME(checkProductShape)(T_TYPE *matA, T_TYPE *matB, T_TYPE *matC)
+{
+  if (matA->y != matB->x)
+  {
+    printf("Error: The number of columns of matrix A must be equal to the number of rows of matrix B.\n");
+    exit(1);
+  }
+  if (matC->x != matA->x || matC->y != matB->y)
+  {
+    printf("Error: Matrix C must have as many rows as matrix A and as many columns as matrix B.\n");
+    exit(1);
+  }
+}
+
+//* Add two matrices (C = A + B)
+void T_NAME(addMatrix)(T_TYPE *matA, T_TYPE *matB, T_TYPE *matC)
+{
+  T_NAME(checkShape)(matA, matC);
+  T_NAME(checkShape)(matB, matC);
+  for (unsigned i = 0; i < matC->x; i++)
+  {
+    const T_ELEM *a = T_NAME(rowMat)(matA, i);
+    const T_ELEM *b = T_NAME(rowMat)(matB, i);
+    T_ELEM *c = T_NAME(rowMat)(matC, i);
+    for (unsigned j = 0; j < matC->y; j++)
+    {
+      c[j] = T_ADD(a[j], b[j]);
+    }
+  }
+}
+
+//* Subtract two matrices (C = A - B)
+void T_NAME(subMatrix)(T_TYPE *matA, T_TYPE *matB, T_TYPE *matC)
+{
+  T_NAME(checkShape)(matA, matC);
+  T_NAME(checkShape)(matB, matC);
+  for (unsigned i = 0; i < matC->x; i++)
+  {
+    const T_ELEM *a = T_NAME(rowMat)(matA, i);
+    const T_ELEM *b = T_NAME(rowMat)(matB, i);
+    T_ELEM *c = T_NAME(rowMat)(matC, i);
+    for (unsigned j = 0; j < matC->y; j++)
+    {
+      c[j] = T_SUB(a[j], b[j]);
+    }
+  }
+}
+
+// Combine four matrices (E = A + B - C + D), the shape of C11 and C22 in Strassen's algorithm
+static void T_NAME(combineMatrix)(T_TYPE *matA, T_TYPE *matB, T_TYPE *matC, T_TYPE *matD, T_TYPE *matE)
+{
+  T_NAME(checkShape)(matA, matE);
+  T_NAME(checkShape)(matB, matE);
+  T_NAME(checkShape)(matC, matE);
+  T_NAME(checkShape)(matD, matE);
+  for (unsigned i = 0; i < matE->x; i++)
+  {
+    const T_ELEM *a = T_NAME(rowMat)(matA, i);
+    const T_ELEM *b = T_NAME(rowMat)(matB, i);
+    const T_ELEM *c = T_NAME(rowMat)(matC, i);
+    const T_ELEM *d = T_NAME(rowMat)(matD, i);
+    T_ELEM *e = T_NAME(rowMat)(matE, i);
+    for (unsigned j = 0; j < matE->y; j++)
+    {
+      e[j] = T_ADD(T_SUB(T_ADD(a[j], b[j]), c[j]), d[j]);
+    }
+  }
+}
+
+#ifdef T_BLOCK_K
+//* Calculate the product of two matrices (C = A * B) with the classical algorithm, blocked like multiplyClassic()
+void T_NAME(multiplyClassic)(T_TYPE *matA, T_TYPE *matB, T_TYPE *matC)
+{
+  unsigned m = matA->x;
+  unsigned p = matA->y;
+  unsigned n = matB->y;
+  T_NAME(checkProductShape)(matA, matB, matC);
+  T_NAME(checkBlockMat)(matB, 0, 0, p, n);
+  T_NAME(checkBlockMat)(matC, 0, 0, m, n);
+  for (unsigned i = 0; i < m; i++)
+  {
+    T_ELEM *c = T_NAME(rowMat)(matC, i);
+    for (unsigned j = 0; j < n; j++)
+    {
+      c[j] = 0;
+    }
+  }
+
+  for (unsigned kk = 0; kk < p; kk += T_BLOCK_K)
+  {
+    unsigned kEnd = kk + T_BLOCK_K < p ? kk + T_BLOCK_K : p;
+    for (unsigned jj = 0; jj < n; jj += T_BLOCK_N)
+    {
+      unsigned width = jj + T_BLOCK_N < n ? T_BLOCK_N : n - jj;
+      unsigned i = 0;
+      for (; i + 4 <= m; i += 4)
+      {
+        T_ELEM *restrict c0 = T_NAME(rowMat)(matC, i) + jj;
+        T_ELEM *restrict c1 = T_NAME(rowMat)(matC, i + 1) + jj;
+        T_ELEM *restrict c2 = T_NAME(rowMat)(matC, i + 2) + jj;
+        T_ELEM *restrict c3 = T_NAME(rowMat)(matC, i + 3) + jj;
+        const T_ELEM *a0 = T_NAME(rowMat)(matA, i), *a1 = T_NAME(rowMat)(matA, i + 1);
+        const T_ELEM *a2 = T_NAME(rowMat)(matA, i + 2), *a3 = T_NAME(rowMat)(matA, i + 3);
+        for (unsigned k = kk; k < kEnd; k++)
+        {
+          const T_ELEM *restrict b = T_NAME(rowMat)(matB, k) + jj;
+          T_ELEM a0k = a0[k], a1k = a1[k], a2k = a2[k], a3k = a3[k];
+          for (unsigned j = 0; j < width; j++)
+          {
+            T_ELEM bj = b[j];
+            c0[j] += a0k * bj;
+            c1[j] += a1k * bj;
+            c2[j] += a2k * bj;
+            c3[j] += a3k * bj;
+          }
+        }
+      }
+      // The rows left over
+      for (; i < m; i++)
+      {
+        T_ELEM *restrict c = T_NAME(rowMat)(matC, i) + jj;
+        const T_ELEM *a = T_NAME(rowMat)(matA, i);
+        for (unsigned k = kk; k < kEnd; k++)
+        {
+          const T_ELEM *restrict b = T_NAME(rowMat)(matB, k) + jj;
+          for (unsigned j = 0; j < width; j++)
+          {
+            c[j] += a[k] * b[j];
+          }
+        }
+      }
+    }
+  }
+}
+#endif
+
+// The recursion is private to Typed.c: these declarations give the definitions in StrassenTemplate.h internal linkage
+static void T_NAME(peelMatrix)(T_TYPE *matA, T_TYPE *matB, T_TYPE *matC);
+static void T_NAME(strassenRecursive)(T_TYPE *matA, T_TYPE *matB, T_TYPE *matC, T_NAME(ARENA) *arena);
+#include "StrassenTemplate.h"
+
+//* Calculate the product of two matrices (C = A * B) using Strassen's algorithm
+void T_NAME(Strassen)(T_TYPE *matA, T_TYPE *matB, T_TYPE *matC)
+{
+  unsigned m = matA->x, p = matA->y, n = matB->y;
+  T_NAME(checkProductShape)(matA, matB, matC);
+
+  T_NAME(ARENA) *arena = T_NAME(newArena)(strassenWorkspace(m, p, n));
+  T_NAME(strassenRecursive)(matA, matB, matC, arena);
+  T_NAME(freeArena)(arena);
+}
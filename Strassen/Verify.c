@@ -0,0 +1,102 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+#include "Matrix.h"
+#include "Verify.h"
+
+// Rounds of Freivalds' check run by checkProduct() after every multiplication; 0 turns the check off
+unsigned verifyRounds = 0;
+
+static void errorVerify(char *str)
+{
+  perror(str);
+  exit(EXIT_FAILURE);
+}
+
+// xorshift64* generator, one per thread so that products can be verified on several threads at once.
+// Each is seeded on first use from the clock and the address of its state, which differs between threads.
+static _Thread_local uint64_t verifyState;
+
+static uint32_t randomVerify(void)
+{
+  if (verifyState == 0)
+  {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    verifyState = ((uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec) ^ (uint64_t)(uintptr_t)&verifyState;
+    verifyState |= 1;
+  }
+  verifyState ^= verifyState >> 12;
+  verifyState ^= verifyState << 25;
+  verifyState ^= verifyState >> 27;
+  return (uint32_t)((verifyState * 0x2545F4914F6CDD1Dull) >> 32);
+}
+
+//* Check C = A * B with Freivalds' algorithm: for `rounds` random vectors r, compare A (B r) with C r.
+// A round costs O(mp + pn + mn) instead of the O(mpn) of recomputing the product, and a wrong C passes it with
+// probability at most 1/2. Returns 1 if every round passes and 0 otherwise.
+// The arithmetic wraps around modulo 2^32, as the products of int matrices do.
+int verifyProduct(MAT *matA, MAT *matB, MAT *matC, unsigned rounds)
+{
+  unsigned m = matA->x, p = matA->y, n = matB->y;
+  if (p != matB->x || matC->x != m || matC->y != n)
+  {
+    return 0;
+  }
+  uint32_t *r, *br;
+  if ((r = (uint32_t *)malloc(((unsigned long)n + 1) * sizeof(uint32_t))) == NULL ||
+      (br = (uint32_t *)malloc(((unsigned long)p + 1) * sizeof(uint32_t))) == NULL)
+  {
+    errorVerify("verifyProduct: no more memory");
+  }
+
+  int pass = 1;
+  for (unsigned round = 0; pass && round < rounds; round++)
+  {
+    for (unsigned j = 0; j < n; j++)
+    {
+      r[j] = randomVerify();
+    }
+    // B r
+    for (unsigned k = 0; k < p; k++)
+    {
+      const int *b = rowMat(matB, k);
+      uint32_t sum = 0;
+      for (unsigned j = 0; j < n; j++)
+      {
+        sum += (uint32_t)b[j] * r[j];
+      }
+      br[k] = sum;
+    }
+    // A (B r) against C r, row by row
+    for (unsigned i = 0; pass && i < m; i++)
+    {
+      const int *a = rowMat(matA, i);
+      const int *c = rowMat(matC, i);
+      uint32_t abr = 0, cr = 0;
+      for (unsigned k = 0; k < p; k++)
+      {
+        abr += (uint32_t)a[k] * br[k];
+      }
+      for (unsigned j = 0; j < n; j++)
+      {
+        cr += (uint32_t)c[j] * r[j];
+      }
+      pass = abr == cr;
+    }
+  }
+  free(r);
+  free(br);
+  return pass;
+}
+
+//* Verify a product just computed when verifyRounds is set, stopping the program if it is wrong
+void checkProduct(MAT *matA, MAT *matB, MAT *matC)
+{
+  if (verifyRounds > 0 && !verifyProduct(matA, matB, matC, verifyRounds))
+  {
+    printf("Error: The product failed verification.\n");
+    exit(1);
+  }
+}
@@ -0,0 +1,7 @@
+// Rounds of Freivalds' check used by "-verify": a wrong product passes with probability at most 2^-VERIFY_ROUNDS
+#define VERIFY_ROUNDS 20
+
+extern unsigned verifyRounds;
+
+int verifyProduct(MAT *matA, MAT *matB, MAT *matC, unsigned rounds);
+void checkProduct(MAT *matA, MAT *matB, MAT *matC);